@@ -91,6 +91,16 @@ static Int32 GetIntFromJs(GS::Ref<JS::Base> p, Int32 def = 0)
 	return def;
 }
 
+// --- Алгоритм раскроя из списка палитры: 0 — жадный, 1 — column generation, 2 — SVC ---
+static CuttingStock::SolverMode SolverModeFromJs(Int32 value)
+{
+	switch (value) {
+		case 1: return CuttingStock::SolverMode::ColumnGeneration;
+		case 2: return CuttingStock::SolverMode::SequentialValueCorrection;
+		default: return CuttingStock::SolverMode::Greedy;
+	}
+}
+
 
 static GS::UniString GetStringFromJavaScriptVariable(GS::Ref<JS::Base> jsVariable)
 {
@@ -462,6 +472,12 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 		double slitMM = 0.0;
 		short floorInd = 0;
 		double extraLenMM = 20.0; // допуск по длине по умолчанию, мм
+		CuttingStock::SolverMode mode = CuttingStock::SolverMode::Greedy;
+		bool saveJob = false;
+		Int32 stationCount = 1;
+		double usefulMinMM = -1.0;   // < 0 — A и B по умолчанию
+		double wasteMaxMM = -1.0;
+		bool strictAB = false;
 
 		if (param != nullptr) {
 			if (GS::Ref<JS::Array> arr = GS::DynamicCast<JS::Array>(param)) {
@@ -472,15 +488,73 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 					floorInd = static_cast<short>(GetIntFromJs(items[1], 0));
 				if (items.GetSize() > 2)
 					extraLenMM = GetDoubleFromJs(items[2], 20.0);
+				if (items.GetSize() > 3)
+					mode = SolverModeFromJs(GetIntFromJs(items[3], 0));
+				if (items.GetSize() > 4)
+					saveJob = GetIntFromJs(items[4], 0) == 1;
+				if (items.GetSize() > 5)
+					stationCount = GetIntFromJs(items[5], 1);
+				if (items.GetSize() > 6)
+					usefulMinMM = GetDoubleFromJs(items[6], -1.0);
+				if (items.GetSize() > 7)
+					wasteMaxMM = GetDoubleFromJs(items[7], -1.0);
+				if (items.GetSize() > 8)
+					strictAB = GetIntFromJs(items[8], 0) == 1;
 			} else {
 				slitMM = GetDoubleFromJs(param, 0.0);
 			}
 		}
 
-		const bool ok = CutPlanBoardHelper::RunCuttingPlan(slitMM, extraLenMM, floorInd);
+		const bool ok = CutPlanBoardHelper::RunCuttingPlan(slitMM, extraLenMM, floorInd, mode, saveJob, stationCount,
+			usefulMinMM, wasteMaxMM, strictAB);
 		return new JS::Value(ok);
 	}));
 
+	// Подбор параметров: [пропил от, до, шаг, допуск от, до, шаг, A от, до, шаг, B от, до, шаг, алгоритм, strictAB оба];
+	// шаг <= 0 или «до» <= «от» — одно значение «от»; возвращает фронт Парето
+	jsACAPI->AddItem(new JS::Function("RunParameterSweep", [](GS::Ref<JS::Base> param) -> GS::Ref<JS::Base> {
+		GS::Array<double> v;
+		if (GS::Ref<JS::Array> arr = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = arr->GetItemArray();
+			for (UIndex i = 0; i < items.GetSize(); ++i)
+				v.Push(GetDoubleFromJs(items[i], 0.0));
+		}
+		while (v.GetSize() < 14)
+			v.Push(0.0);
+
+		CuttingStock::SweepSpec spec;
+		spec.slit = CuttingStock::SweepValues(v[0] > 0.0 ? v[0] : 4.0, v[1], v[2]);
+		spec.extraLenMM = CuttingStock::SweepValues(v[3], v[4], v[5]);
+		if (v[6] > 0.0) spec.usefulMin = CuttingStock::SweepValues(v[6], v[7], v[8]);
+		if (v[9] > 0.0) spec.wasteMax = CuttingStock::SweepValues(v[9], v[10], v[11]);
+		if (v[13] != 0.0) spec.strictAB = { false, true };
+		const CuttingStock::SolverMode mode = SolverModeFromJs(static_cast<int>(v[12]));
+
+		const CuttingStock::SweepResult result = CutPlanBoardHelper::RunParameterSweep(spec.extraLenMM[0], mode, spec);
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("tooLarge", new JS::Value(result.tooLarge));
+		jsResult->AddItem("interrupted", new JS::Value(result.interrupted));
+		jsResult->AddItem("points", new JS::Value(static_cast<Int32>(result.plans.size())));
+		GS::Ref<JS::Array> jsFront = new JS::Array();
+		for (size_t i : result.front) {
+			const CuttingStock::SweepPlan& plan = result.plans[i];
+			GS::Ref<JS::Object> obj = new JS::Object();
+			obj->AddItem("slit", new JS::Value(plan.point.slit));
+			obj->AddItem("extraLen", new JS::Value(plan.point.extraLenMM));
+			obj->AddItem("usefulMin", new JS::Value(plan.point.usefulMin));
+			obj->AddItem("wasteMax", new JS::Value(plan.point.wasteMax));
+			obj->AddItem("strictAB", new JS::Value(plan.point.strictAB));
+			obj->AddItem("boards", new JS::Value(static_cast<Int32>(plan.boards)));
+			obj->AddItem("unplaced", new JS::Value(static_cast<Int32>(plan.unplaced)));
+			obj->AddItem("wasteMM", new JS::Value(plan.wasteMM));
+			obj->AddItem("setups", new JS::Value(static_cast<Int32>(plan.setups)));
+			obj->AddItem("usefulOffcuts", new JS::Value(static_cast<Int32>(plan.usefulOffcuts)));
+			jsFront->AddItem(obj);
+		}
+		jsResult->AddItem("front", jsFront);
+		return jsResult;
+	}));
+
 	// --- Help / Palettes ---
 	jsACAPI->AddItem(new JS::Function("OpenHelp", [](GS::Ref<JS::Base> param) {
 		GS::UniString url;
@@ -1,17 +1,26 @@
 #include "CutPlanBoardHelper.hpp"
 #include "APICommon.h"
 #include "CH.hpp"
+#include "CuttingStockJob.hpp"
+#include "CuttingStockSweep.hpp"
+#include "OffcutInventory.hpp"
+#include "SolverAdapter.hpp"
+#include "SolverCache.hpp"
+#include "UserDataFile.hpp"
 #include <Windows.h>
 #include <commdlg.h>
 #include <cwchar>
-#include <cstdarg>
 #include <cstdio>
-#include <cmath>
+#include <set>
+#include <utility>
 
 namespace CutPlanBoardHelper {
 
 namespace {
 
+// Общий лимит решения в RunCuttingPlan, мс
+const int kSolveTimeLimitMs = 20000;
+
 static double GetAddParReal(API_AddParType* const* params, Int32 count, const char* parName)
 {
 	if (params == nullptr || *params == nullptr) return 0.0;
@@ -134,85 +143,88 @@ bool GetArchiFramePlankParams(const API_Guid& guid, ArchiFramePlankParams& out)
 	return (out.iLen > 0 && out.iMaxLen > 0);
 }
 
-GS::Array<CuttingStock::Part> CollectPartsFromSelection(double& outMaxStockLength)
-{
-	GS::Array<CuttingStock::Part> parts;
-	outMaxStockLength = 6000.0;
-
-	API_SelectionInfo selInfo = {};
-	GS::Array<API_Neig> selNeigs;
-	ACAPI_Selection_Get(&selInfo, &selNeigs, false, false);
-	BMKillHandle((GSHandle*)&selInfo.marquee.coords);
-
-	for (const API_Neig& n : selNeigs) {
-		if (!IsArchiFramePlank(n.guid))
-			continue;
-		ArchiFramePlankParams p;
-		if (!GetArchiFramePlankParams(n.guid, p))
-			continue;
-		if (p.iMaxLen > 0)
-			outMaxStockLength = p.iMaxLen;
-		CuttingStock::Part part;
-		part.length = p.iLen;
-		part.boardW = p.iHeight > 0 ? p.iHeight : 100.0;
-		part.material = p.material;
-		if (part.material.IsEmpty())
-			part.material = GS::UniString::Printf("%.0f", p.iWidth);
-		parts.Push(part);
-	}
-	return parts;
-}
+namespace {
 
-GS::Array<ArchiFrameSummaryRow> CollectArchiFrameSummaryFromSelection()
+// Доски выделения за один проход: параметры каждой доски читаются один раз, ширины и сечения
+// сопоставляются по таблицам профилей, а не перебором строк
+struct SelectionPlanks {
+	CuttingStock::ProfileTable profiles;          // (толщина, ширина, материал) — профили спроса
+	CuttingStock::ProfileTable sectionProfiles;   // (толщина, ширина) — id совпадает с индексом summary
+	CuttingStock::DemandSet demand;
+	std::vector<CuttingStock::StockType> stockTypes;
+	GS::Array<ArchiFrameSummaryRow> summary;
+};
+
+static SelectionPlanks CollectSelectionPlanks()
 {
-	GS::Array<ArchiFrameSummaryRow> rows;
+	SelectionPlanks planks;
 
 	API_SelectionInfo selInfo = {};
 	GS::Array<API_Neig> selNeigs;
 	ACAPI_Selection_Get(&selInfo, &selNeigs, false, false);
 	BMKillHandle((GSHandle*)&selInfo.marquee.coords);
 
+	std::set<std::pair<CuttingStock::Int64, CuttingStock::Int64>> knownStock;
 	for (const API_Neig& n : selNeigs) {
 		if (!IsArchiFramePlank(n.guid))
 			continue;
-
 		ArchiFramePlankParams p;
 		if (!GetArchiFramePlankParams(n.guid, p))
 			continue;
 
-		const double widthMM = p.iWidth;
-		const double heightMM = p.iHeight;
-		const GS::UniString label = BuildMaterialLabel(widthMM, heightMM);
-		const GS::UniString guidStr = APIGuidToString(n.guid);
-
-		ArchiFrameSummaryRow* targetRow = nullptr;
-		for (UIndex i = 0; i < rows.GetSize(); ++i) {
-			ArchiFrameSummaryRow& row = rows[i];
-			if (std::fabs(row.widthMM - widthMM) < 0.001 &&
-				std::fabs(row.heightMM - heightMM) < 0.001) {
-				targetRow = &row;
-				break;
-			}
-		}
-
-		if (targetRow == nullptr) {
+		// Спрос: каждая пара (iMaxLen, ширина) — отдельный тип заготовки; цена пропорциональна длине
+		const double boardW = p.iHeight > 0 ? p.iHeight : 100.0;
+		if (knownStock.insert({ CuttingStock::SizeKey(p.iMaxLen), CuttingStock::SizeKey(boardW) }).second)
+			planks.stockTypes.push_back({ p.iMaxLen, p.iMaxLen / 1000.0, -1, 0, boardW });
+		const GS::UniString material = p.material.IsEmpty() ? GS::UniString::Printf("%.0f", p.iWidth) : p.material;
+		const UInt32 profile = planks.profiles.Intern(p.iWidth, boardW, SolverAdapter::ToUtf8(material));
+		planks.profiles.AddDemand(planks.demand, profile, p.iLen);
+
+		// Сводка по сечениям (толщина, ширина)
+		const UInt32 section = planks.sectionProfiles.Intern(p.iWidth, p.iHeight, std::string());
+		if (section == planks.summary.GetSize()) {
 			ArchiFrameSummaryRow row;
-			row.widthMM = widthMM;
-			row.heightMM = heightMM;
-			row.materialLabel = label;
+			row.widthMM = p.iWidth;
+			row.heightMM = p.iHeight;
+			row.materialLabel = BuildMaterialLabel(p.iWidth, p.iHeight);
 			row.count = 0;
 			row.totalLenMM = 0.0;
 			row.maxLenMM = p.iMaxLen;
-			rows.Push(row);
-			targetRow = &rows[rows.GetSize() - 1];
+			planks.summary.Push(row);
 		}
-
-		targetRow->count += 1;
-		targetRow->totalLenMM += p.iLen;
-		targetRow->guidStrs.Push(guidStr);
+		ArchiFrameSummaryRow& row = planks.summary[section];
+		row.count += 1;
+		row.totalLenMM += p.iLen;
+		row.guidStrs.Push(APIGuidToString(n.guid));
 	}
+	return planks;
+}
 
-	return rows;
+static std::vector<FastProduction::SectionRow> ToSectionRows(const GS::Array<ArchiFrameSummaryRow>& rows)
+{
+	std::vector<FastProduction::SectionRow> sections;
+	for (UIndex i = 0; i < rows.GetSize(); ++i)
+		sections.push_back({ rows[i].widthMM, rows[i].heightMM, static_cast<Int32>(rows[i].count), rows[i].totalLenMM, rows[i].maxLenMM });
+	return sections;
+}
+
+} // anonymous
+
+CuttingStock::DemandSet CollectDemandFromSelection(std::vector<CuttingStock::StockType>& outStockTypes)
+{
+	SelectionPlanks planks = CollectSelectionPlanks();
+	outStockTypes = std::move(planks.stockTypes);
+	return std::move(planks.demand);
+}
+
+GS::Array<ArchiFrameSummaryRow> CollectArchiFrameSummaryFromSelection()
+{
+	return CollectSelectionPlanks().summary;
+}
+
+std::vector<FastProduction::SectionRow> CollectSectionsFromSelection()
+{
+	return ToSectionRows(CollectArchiFrameSummaryFromSelection());
 }
 
 CuttingStock::SolverParams DefaultSolverParams()
@@ -224,181 +236,21 @@ CuttingStock::SolverParams DefaultSolverParams()
 	p.wasteMax = 50.0;
 	p.strictAB = false;
 	p.maxImproveIter = 2000;
+	p.improveTimeMs = 300;
+	p.mode = CuttingStock::SolverMode::Greedy;
+	p.groupByMaterial = true;   // остатки и заготовки учитываются по материалу (сечению)
+	p.threadCount = 0;
+	p.exactNodeLimit = 200000;
+	p.exactTimeMs = 200;
+	p.patternReduceIter = 200000;
+	p.patternWasteWeight = 0.5;
+	p.svcPasses = 10;
 	return p;
 }
 
 GS::UniString BuildCutPlanCsv(const CuttingStock::SolverResult& result, double slit, FastProduction::ScenarioData* outScenarioData)
 {
-	GS::UniString csv;
-	FastProduction::ScenarioData scenarioData;
-	if (outScenarioData) {
-		scenarioData = FastProduction::BuildScenarioData(result, 1, true, 2);
-		*outScenarioData = scenarioData;
-	}
-
-	// Определяем максимальное количество отрезков на доску,
-	// чтобы сформировать заголовок Cut1..CutN и строки полной ширины.
-	UIndex maxCuts = 0;
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		const CuttingStock::ResultBoard& rb = result.boards[b];
-		if (rb.cuts.GetSize() > maxCuts)
-			maxCuts = rb.cuts.GetSize();
-	}
-
-	csv += "Board;BoardW;";
-	for (UIndex c = 0; c < maxCuts; ++c) {
-		csv += GS::UniString::Printf("Cut%u;", (unsigned)(c + 1));
-	}
-	csv += "Remainder;Kerf";
-	if (outScenarioData) {
-		csv += ";ScenarioId;ScenarioOps;ScenarioSetups;ScenarioGroup";
-	}
-	csv += "\r\n";
-
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		const CuttingStock::ResultBoard& rb = result.boards[b];
-		csv += GS::UniString::Printf("%d;%.0f;", (int)(b + 1), rb.boardW);
-		for (UIndex c = 0; c < maxCuts; ++c) {
-			if (c < rb.cuts.GetSize())
-				csv += GS::UniString::Printf("%.0f;", rb.cuts[c]);
-			else
-				csv += ";";
-		}
-		csv += GS::UniString::Printf("%.0f;%.0f", rb.remainder, slit);
-		if (outScenarioData && b < scenarioData.boardScenarioId.GetSize()) {
-			csv += ";";
-			csv += scenarioData.boardScenarioId[b];
-			csv += ";";
-			csv += scenarioData.boardScenarioOps[b];
-			csv += ";";
-			csv += GS::UniString::Printf("%d", scenarioData.boardScenarioSetups[b]);
-			csv += ";";
-			csv += scenarioData.boardScenarioGroup[b];
-		}
-		csv += "\r\n";
-	}
-	csv += "\r\n";
-	csv += "Remaining parts (length;boardW;material)\r\n";
-	for (UIndex i = 0; i < result.remaining.GetSize(); ++i) {
-		const CuttingStock::Part& p = result.remaining[i];
-		csv += GS::UniString::Printf("%.0f;%.0f;%s\r\n", p.length, p.boardW, p.material.ToCStr().Get());
-	}
-
-	// Сводка по пиломатериалам: толщина/ширина, количество и объём в м3
-	csv += "\r\n";
-	csv += "Material summary (boardT_mm;boardW_mm;count;volume_m3)\r\n";
-	GS::Array<ArchiFrameSummaryRow> summaryRows = CollectArchiFrameSummaryFromSelection();
-	for (UIndex i = 0; i < summaryRows.GetSize(); ++i) {
-		const ArchiFrameSummaryRow& row = summaryRows[i];
-		const double boardTmm = row.widthMM;   // толщина (iWidth)
-		const double boardWmm = row.heightMM;  // ширина (iHeight)
-		const double maxLenMM = (row.maxLenMM > 0.0 ? row.maxLenMM : 6000.0);
-		double boardsCountD = 0.0;
-		if (maxLenMM > 0.0 && row.totalLenMM > 0.0)
-			boardsCountD = std::ceil(row.totalLenMM / maxLenMM);
-		const unsigned boardsCount = boardsCountD > 0.0 ? (unsigned)boardsCountD : 0u;
-
-		const double boardTm = boardTmm / 1000.0;
-		const double boardWm = boardWmm / 1000.0;
-		const double maxLenM = maxLenMM / 1000.0;
-		const double volumeM3 = boardsCount * maxLenM * boardTm * boardWm;
-		csv += GS::UniString::Printf("%.0f;%.0f;%u;%.3f\r\n", boardTmm, boardWmm, boardsCount, volumeM3);
-	}
-
-	// Сводка по отрезкам: толщина/ширина доски и длина отрезка
-	csv += "\r\n";
-	csv += "Cut summary (boardT_mm;boardW_mm;cutLen_mm;count)\r\n";
-
-	struct CutSummaryRow {
-		double boardTmm;
-		double boardWmm;
-		double cutLenMM;
-		unsigned count;
-	};
-
-	GS::Array<CutSummaryRow> cutSummary;
-
-	// Карта height (ширина) -> thickness (толщина) по исходной сводке
-	auto FindThicknessForWidth = [&summaryRows](double boardWmm) -> double {
-		for (UIndex i = 0; i < summaryRows.GetSize(); ++i) {
-			const ArchiFrameSummaryRow& row = summaryRows[i];
-			if (std::fabs(row.heightMM - boardWmm) < 0.001) {
-				return row.widthMM;
-			}
-		}
-		return 0.0;
-	};
-
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		const CuttingStock::ResultBoard& rb = result.boards[b];
-		const double boardWmm = rb.boardW;                // ширина
-		const double boardTmm = FindThicknessForWidth(boardWmm); // толщина
-
-		for (UIndex c = 0; c < rb.cuts.GetSize(); ++c) {
-			double cutLenMM = rb.cuts[c];
-			if (cutLenMM <= 0.0)
-				continue;
-
-			// Нормализуем до целых мм
-			cutLenMM = std::round(cutLenMM);
-
-			// Ищем существующую запись
-			CutSummaryRow* row = nullptr;
-			for (UIndex k = 0; k < cutSummary.GetSize(); ++k) {
-				CutSummaryRow& r = cutSummary[k];
-				if (std::fabs(r.boardTmm - boardTmm) < 0.001 &&
-					std::fabs(r.boardWmm - boardWmm) < 0.001 &&
-					std::fabs(r.cutLenMM - cutLenMM) < 0.001) {
-					row = &r;
-					break;
-				}
-			}
-
-			if (row == nullptr) {
-				CutSummaryRow r;
-				r.boardTmm = boardTmm;
-				r.boardWmm = boardWmm;
-				r.cutLenMM = cutLenMM;
-				r.count = 0;
-				cutSummary.Push(r);
-				row = &cutSummary[cutSummary.GetSize() - 1];
-			}
-
-			row->count += 1;
-		}
-	}
-
-	// Сортируем по толщине, ширине, длине
-	for (UIndex i = 0; i < cutSummary.GetSize(); ++i) {
-		for (UIndex j = i + 1; j < cutSummary.GetSize(); ++j) {
-			const CutSummaryRow& a = cutSummary[i];
-			const CutSummaryRow& bRow = cutSummary[j];
-
-			bool swap = false;
-			if (a.boardTmm > bRow.boardTmm + 0.001) {
-				swap = true;
-			} else if (std::fabs(a.boardTmm - bRow.boardTmm) < 0.001 && a.boardWmm > bRow.boardWmm + 0.001) {
-				swap = true;
-			} else if (std::fabs(a.boardTmm - bRow.boardTmm) < 0.001 &&
-					   std::fabs(a.boardWmm - bRow.boardWmm) < 0.001 &&
-					   a.cutLenMM > bRow.cutLenMM + 0.001) {
-				swap = true;
-			}
-
-			if (swap) {
-				CutSummaryRow tmp = cutSummary[i];
-				cutSummary[i] = cutSummary[j];
-				cutSummary[j] = tmp;
-			}
-		}
-	}
-
-	for (UIndex i = 0; i < cutSummary.GetSize(); ++i) {
-		const CutSummaryRow& r = cutSummary[i];
-		csv += GS::UniString::Printf("%.0f;%.0f;%.0f;%u\r\n", r.boardTmm, r.boardWmm, r.cutLenMM, r.count);
-	}
-
-	return csv;
+	return SolverAdapter::FromUtf8(FastProduction::BuildCutPlanCsv(result, slit, CollectSectionsFromSelection(), outScenarioData));
 }
 
 namespace {
@@ -454,121 +306,13 @@ static bool WriteAnsiFile(const wchar_t* path, const GS::UniString& content)
 	return true;
 }
 
-static double FindThicknessForBoardW(const GS::Array<ArchiFrameSummaryRow>& summaryRows, double boardWmm)
-{
-	for (UIndex i = 0; i < summaryRows.GetSize(); ++i) {
-		if (std::fabs(summaryRows[i].heightMM - boardWmm) < 0.001)
-			return summaryRows[i].widthMM;
-	}
-	return 0.0;
-}
-
-static void AppendWideLine(GS::UniString& txt, const wchar_t* fmt, ...)
-{
-	wchar_t buf[1024];
-	va_list args;
-	va_start(args, fmt);
-	int n = vswprintf_s(buf, fmt, args);
-	va_end(args);
-	if (n > 0)
-		txt += GS::UniString(buf);
-}
-
-static GS::UniString BuildOperatorInstructions(const FastProduction::ScenarioData& scenarioData,
-	const CuttingStock::SolverResult& result,
-	const GS::Array<ArchiFrameSummaryRow>& summaryRows)
-{
-	GS::UniString txt;
-	/* Use wide string literals (L"...") so Cyrillic is correct; then WriteAnsiFile(1251) will convert properly. */
-	if (!result.boards.IsEmpty()) {
-		GS::Array<double> widths;
-		for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-			double w = result.boards[b].boardW;
-			bool found = false;
-			for (UIndex d = 0; d < widths.GetSize(); ++d) {
-				if (std::fabs(widths[d] - w) < 0.001) { found = true; break; }
-			}
-			if (!found)
-				widths.Push(w);
-		}
-		AppendWideLine(txt, L"=== \u0412\u0441\u0435\u0433\u043E \u0434\u043E\u0441\u043E\u043A ===\r\n");
-		for (UIndex d = 0; d < widths.GetSize(); ++d) {
-			double boardW = widths[d];
-			UInt32 count = 0;
-			for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-				if (std::fabs(result.boards[b].boardW - boardW) < 0.001)
-					count++;
-			}
-			double thickness = FindThicknessForBoardW(summaryRows, boardW);
-			if (thickness < 0.001) thickness = 0.0;
-			AppendWideLine(txt, L"\u0412\u0441\u0435\u0433\u043E %u \u0448\u0442 %.0fx%.0f \u043C\u043C\r\n", (unsigned)count, thickness, boardW);
-		}
-		txt += GS::UniString(L"\r\n\r\n");
-	}
-
-	AppendWideLine(txt, L"=== \u041F\u0440\u043E\u0433\u0440\u0430\u043C\u043C\u044B \u0440\u0430\u0441\u043F\u0438\u043B\u0430 ===\r\n\r\n");
-	for (UIndex s = 0; s < scenarioData.scenarios.GetSize(); ++s) {
-		const FastProduction::ScenarioInfo& info = scenarioData.scenarios[s];
-		double thickness = FindThicknessForBoardW(summaryRows, info.boardW);
-		if (thickness < 0.001) thickness = 0.0;
-		/* ScenarioId is ASCII (e.g. W195_S00); convert to wide for format */
-		GS::UniString sid = info.scenarioId;
-		AppendWideLine(txt, L"--- %s (\u0411\u0435\u0440\u0451\u043C %d \u0434\u043E\u0441\u043E\u043A %.0fx%.0f \u043C\u043C) ---\r\n",
-			sid.ToUStr().Get(), info.boardsCount, thickness, info.boardW);
-		const bool oneSetup = (info.steps.GetSize() == 1);
-		for (UIndex r = 0; r < info.steps.GetSize(); ++r) {
-			const FastProduction::ScenarioStepInfo& step = info.steps[r];
-			const bool isFirst = (r == 0);
-			const bool isLast = (r == info.steps.GetSize() - 1);
-			if (oneSetup) {
-				AppendWideLine(txt, L"\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u043F\u0438\u043B\u0438\u043C \u0431\u0435\u0437 \u043E\u0441\u0442\u0430\u0442\u043A\u0430 (%d \u0440\u0435\u0437\u043E\u0432 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439 \u0434\u043E\u0441\u043A\u0438). ", step.stopLength, step.cutsPerBoard);
-				AppendWideLine(txt, L"\u041E\u0441\u0442\u0430\u0442\u043E\u043A %.0f \u043C\u043C \u043D\u0430 \u0434\u043E\u0441\u043A\u0443. \u0412\u0441\u0435\u0433\u043E %d \u0434\u043E\u0441\u043E\u043A, %d \u0440\u0435\u0437\u043E\u0432.\r\n", info.remainderMm, info.boardsCount, step.totalCuts);
-			} else {
-				if (isFirst) {
-					AppendWideLine(txt, L"\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). \u041E\u0441\u0442\u0430\u0442\u043E\u043A \u043E\u0442\u043A\u043B\u0430\u0434\u044B\u0432\u0430\u0435\u043C \u0432 \u043F\u0430\u0447\u043A\u0443.\r\n", step.stopLength, step.cutsPerBoard);
-				} else if (isLast) {
-					AppendWideLine(txt, L"\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u0431\u0435\u0440\u0451\u043C \u043E\u0441\u0442\u0430\u0442\u043E\u043A \u0438\u0437 \u043F\u0430\u0447\u043A\u0438, \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). ", step.stopLength, step.cutsPerBoard);
-					AppendWideLine(txt, L"\u041E\u0441\u0442\u0430\u0442\u043E\u043A %.0f \u043C\u043C \u043D\u0430 \u0434\u043E\u0441\u043A\u0443.\r\n", info.remainderMm);
-				} else {
-					AppendWideLine(txt, L"\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u0431\u0435\u0440\u0451\u043C \u043E\u0441\u0442\u0430\u0442\u043E\u043A \u0438\u0437 \u043F\u0430\u0447\u043A\u0438, \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). \u041E\u0441\u0442\u0430\u0442\u043E\u043A \u0432 \u043F\u0430\u0447\u043A\u0443.\r\n", step.stopLength, step.cutsPerBoard);
-				}
-			}
-		}
-		txt += GS::UniString(L"\r\n");
-	}
-	return txt;
-}
-
-} // anonymous
-
-bool PlaceScenarioTextOnFloor(const GS::UniString& instructionsTxt, short floorIndex)
-{
-	if (instructionsTxt.IsEmpty())
-		return true;
-	API_Element element = {};
-	element.header.type = API_TextID;
-	GSErrCode err = ACAPI_Element_GetDefaults(&element, nullptr);
-	if (err != NoError)
-		return false;
-	element.text.head.floorInd = floorIndex;
-	element.text.loc.x = 1.0;
-	element.text.loc.y = 1.0;
-	if (element.text.width < 100.0)
-		element.text.width = 400.0;
-	if (element.text.height < 50.0)
-		element.text.height = 300.0;
-	API_ElementMemo memo = {};
-	GS::UniString contentCopy = instructionsTxt;
-	memo.textContent = &contentCopy;
-	err = ACAPI_Element_Create(&element, &memo);
-	/* Do not call ACAPI_DisposeElemMemoHdls: we did not allocate memo.textContent. */
-	return (err == NoError);
-}
-
-bool ExportCutPlanToExcel(const CuttingStock::SolverResult& result, double slit, short floorIndex)
+// CSV плана и файлы рядом с ним; сечения для сводок — из задания. saveJob — ещё и само задание (<имя>_job.apjob).
+static bool ExportCutPlan(const CuttingStock::SolverResult& result, double slit, short floorIndex,
+	const CuttingJob::Job& job, bool saveJob)
 {
 	FastProduction::ScenarioData scenarioData;
-	GS::UniString csv = BuildCutPlanCsv(result, slit, &scenarioData);
+	GS::UniString csv = SolverAdapter::FromUtf8(FastProduction::BuildCutPlanCsv(result, slit, job.sections, &scenarioData));
+	FastProduction::ScheduleStations(scenarioData, job.stations);
 	wchar_t pathBuf[MAX_PATH] = L"";
 	OPENFILENAMEW ofn = {};
 	ofn.lStructSize = sizeof(ofn);
@@ -594,31 +338,30 @@ bool ExportCutPlanToExcel(const CuttingStock::SolverResult& result, double slit,
 
 	// set_list.csv
 	swprintf_s(extraPath, L"%s_set_list.csv", basePath);
-	GS::UniString setListCsv;
-	setListCsv += "BoardW;ScenarioId;StopLength;CutsCount;BoardsCount;OpOrder\r\n";
-	for (UIndex i = 0; i < scenarioData.setListRows.GetSize(); ++i) {
-		const FastProduction::SetListRow& row = scenarioData.setListRows[i];
-		setListCsv += GS::UniString::Printf("%.0f;%s;%d;%d;%d;%d\r\n",
-			row.boardW, row.scenarioId.ToCStr().Get(), row.stopLength, row.cutsCount, row.boardsCount, row.opOrder);
+	WriteUtf8File(extraPath, SolverAdapter::FromUtf8(FastProduction::BuildSetListCsv(scenarioData)));
+
+	// set list каждой пилы, если сценарии распределены по нескольким
+	for (size_t st = 0; st < scenarioData.stations.size(); ++st) {
+		swprintf_s(extraPath, L"%s_station%u_set_list.csv", basePath, static_cast<unsigned>(st + 1));
+		WriteUtf8File(extraPath, SolverAdapter::FromUtf8(FastProduction::BuildStationSetListCsv(scenarioData.stations[st])));
 	}
-	WriteUtf8File(extraPath, setListCsv);
 
 	// set_list_summary.csv
 	swprintf_s(extraPath, L"%s_set_list_summary.csv", basePath);
-	GS::UniString summaryCsv;
-	summaryCsv += "BoardW;StopLength;TotalCuts\r\n";
-	for (UIndex i = 0; i < scenarioData.setListSummaryRows.GetSize(); ++i) {
-		const FastProduction::SetListSummaryRow& row = scenarioData.setListSummaryRows[i];
-		summaryCsv += GS::UniString::Printf("%.0f;%d;%d\r\n", row.boardW, row.stopLength, row.totalCuts);
-	}
-	WriteUtf8File(extraPath, summaryCsv);
+	WriteUtf8File(extraPath, SolverAdapter::FromUtf8(FastProduction::BuildSetListSummaryCsv(scenarioData)));
 
 	// operator_instructions.txt (Windows-1251 so Notepad shows Cyrillic)
 	swprintf_s(extraPath, L"%s_operator_instructions.txt", basePath);
-	GS::Array<ArchiFrameSummaryRow> summaryRows = CollectArchiFrameSummaryFromSelection();
-	GS::UniString instructionsTxt = BuildOperatorInstructions(scenarioData, result, summaryRows);
+	GS::UniString instructionsTxt = SolverAdapter::FromUtf8(FastProduction::BuildOperatorInstructions(scenarioData, result, job.sections));
 	WriteAnsiFile(extraPath, instructionsTxt);
 
+	// Задание для Tools/JobRunner: те же входные данные дают тот же план вне Archicad
+	if (saveJob) {
+		swprintf_s(extraPath, L"%s_job.apjob", basePath);
+		if (!WriteUtf8File(extraPath, SolverAdapter::FromUtf8(CuttingJob::Write(job))))
+			ACAPI_WriteReport("Could not write the cutting job file.", false);
+	}
+
 	// Place scenario text on selected floor (API_TextID) so it displays in Archicad
 	if (floorIndex >= 0) {
 		API_StoryInfo storyInfo = {};
@@ -631,6 +374,39 @@ bool ExportCutPlanToExcel(const CuttingStock::SolverResult& result, double slit,
 	return true;
 }
 
+} // anonymous
+
+bool PlaceScenarioTextOnFloor(const GS::UniString& instructionsTxt, short floorIndex)
+{
+	if (instructionsTxt.IsEmpty())
+		return true;
+	API_Element element = {};
+	element.header.type = API_TextID;
+	GSErrCode err = ACAPI_Element_GetDefaults(&element, nullptr);
+	if (err != NoError)
+		return false;
+	element.text.head.floorInd = floorIndex;
+	element.text.loc.x = 1.0;
+	element.text.loc.y = 1.0;
+	if (element.text.width < 100.0)
+		element.text.width = 400.0;
+	if (element.text.height < 50.0)
+		element.text.height = 300.0;
+	API_ElementMemo memo = {};
+	GS::UniString contentCopy = instructionsTxt;
+	memo.textContent = &contentCopy;
+	err = ACAPI_Element_Create(&element, &memo);
+	/* Do not call ACAPI_DisposeElemMemoHdls: we did not allocate memo.textContent. */
+	return (err == NoError);
+}
+
+bool ExportCutPlanToExcel(const CuttingStock::SolverResult& result, double slit, short floorIndex)
+{
+	CuttingJob::Job job;
+	job.sections = CollectSectionsFromSelection();
+	return ExportCutPlan(result, slit, floorIndex, job, false);
+}
+
 void DumpArchiFramePlankParamsToReport()
 {
 	API_SelectionInfo selInfo = {};
@@ -667,26 +443,113 @@ void DumpArchiFramePlankParamsToReport()
 		ACAPI_WriteReport("No ArchiFramePlank in selection. Select at least one ArchiFramePlank and run again.", true);
 }
 
-bool RunCuttingPlan(double slitMM, double extraLenMM, short floorIndex)
+namespace {
+
+// Задание по выделению: спрос, параметры, сечения; склад не читается. false — в выделении нет досок
+static bool BuildSelectionJob(double slitMM, double extraLenMM, CuttingStock::SolverMode mode, CuttingJob::Job& job)
 {
-	double maxStockLength = 0.0;
-	GS::Array<CuttingStock::Part> parts = CollectPartsFromSelection(maxStockLength);
-	if (parts.IsEmpty()) {
+	job.params = DefaultSolverParams();
+	job.params.mode = mode;
+	if (slitMM > 0.0)
+		job.params.slit = slitMM;
+	SelectionPlanks planks = CollectSelectionPlanks();
+	job.demand = std::move(planks.demand);
+	job.params.stockTypes = std::move(planks.stockTypes);
+	if (job.demand.items.empty()) {
 		ACAPI_WriteReport("No ArchiFramePlank objects in selection. Select ArchiFramePlank elements first.", true);
 		return false;
 	}
+	job.extraLenMM = extraLenMM;
+	job.timeLimitMs = kSolveTimeLimitMs;
+	job.sections = ToSectionRows(planks.summary);
+	return true;
+}
 
-	CuttingStock::SolverParams params = DefaultSolverParams();
-	if (slitMM > 0.0)
-		params.slit = slitMM;
-	const double baseMax = (maxStockLength > 0.0 ? maxStockLength : 6000.0);
-	if (extraLenMM > 0.0)
-		params.maxStockLength = baseMax + extraLenMM;
-	else
-		params.maxStockLength = baseMax;
-
-	CuttingStock::SolverResult result = CuttingStock::Solve(parts, params);
-	return ExportCutPlanToExcel(result, params.slit, floorIndex);
+// Деловые остатки со склада — дополнительные заготовки своих групп (ширина, материал)
+static void LoadOffcutStock(const GS::UniString& inventoryPath, CuttingJob::Job& job)
+{
+	const CuttingStock::DemandSet& demand = job.demand;
+	GS::Array<OffcutInventory::GroupKey> groups;
+	std::set<std::pair<CuttingStock::Int64, UInt32>> known;
+	for (size_t i = 0; i < demand.items.size(); ++i) {
+		const CuttingStock::PartDemand& d = demand.items[i];
+		if (known.insert({ CuttingStock::SizeKey(d.boardW), d.materialId }).second)
+			groups.Push({ d.boardW, SolverAdapter::FromUtf8(demand.materials[d.materialId]) });
+	}
+	GS::Array<OffcutInventory::Offcut> offcuts;
+	if (!OffcutInventory::Load(inventoryPath, groups, offcuts))
+		ACAPI_WriteReport("Offcut inventory file is damaged and was ignored.", false);
+	OffcutInventory::AppendAsStock(offcuts, job.offcutStock);
+}
+
+} // anonymous
+
+bool RunCuttingPlan(double slitMM, double extraLenMM, short floorIndex, CuttingStock::SolverMode mode, bool saveJob,
+	Int32 stationCount, double usefulMinMM, double wasteMaxMM, bool strictAB)
+{
+	// Все входные данные решения собираются в задание: оно же при saveJob пишется рядом с CSV
+	CuttingJob::Job job;
+	if (!BuildSelectionJob(slitMM, extraLenMM, mode, job))
+		return false;
+	if (usefulMinMM >= 0.0)
+		job.params.usefulMin = usefulMinMM;
+	if (wasteMaxMM >= 0.0)
+		job.params.wasteMax = wasteMaxMM;
+	job.params.strictAB = strictAB;
+	if (stationCount > 1)
+		job.stations.count = stationCount;
+	const CuttingStock::DemandSet& demand = job.demand;
+	const CuttingStock::SolverParams params = CuttingStock::ApplyExtraLength(job.params, job.extraLenMM);
+
+	// Повторный запуск на том же выборе с теми же параметрами, пока склад не менялся, — план из кэша.
+	// Склад уже учитывает этот план, поэтому повторно не обновляется.
+	// Задание пишется только для настоящего решения: в нём склад, с которым план получен.
+	const GS::UniString inventoryPath = OffcutInventory::DefaultPath();
+	const GS::UniString cachePath = SolverCache::DefaultPath();
+	CuttingStock::PatternResult patterns;
+	if (!saveJob && SolverCache::Lookup(cachePath, demand, params, UserDataFile::ContentHash(inventoryPath), patterns))
+		return ExportCutPlan(CuttingStock::ExpandResult(patterns, demand), params.slit, floorIndex, job, false);
+
+	LoadOffcutStock(inventoryPath, job);
+	const CuttingStock::SolverParams solveParams = CuttingJob::SolveParams(job);
+	const size_t firstOffcutStock = params.stockTypes.size();
+
+	// Решаем по агрегированному спросу; поштучный вид нужен только экспорту.
+	// Решение идёт в UI-потоке: по истечении лимита берём лучший найденный план
+	CuttingStock::SolveControl control;
+	control.timeLimitMs = job.timeLimitMs;
+	patterns = CuttingStock::Solve(demand, solveParams, control);
+	const CuttingStock::SolverResult result = CuttingStock::ExpandResult(patterns, demand);
+	if (!ExportCutPlan(result, params.slit, floorIndex, job, saveJob))
+		return false;
+
+	// План принят: списываем взятые со склада остатки и кладём новые (>= usefulMin)
+	GS::Array<OffcutInventory::Offcut> used;
+	GS::Array<OffcutInventory::Offcut> produced;
+	OffcutInventory::CollectChanges(result, demand, solveParams.stockTypes, firstOffcutStock, params.usefulMin, used, produced);
+	if (!OffcutInventory::Update(inventoryPath, used, produced)) {
+		ACAPI_WriteReport("Could not update offcut inventory file.", false);
+		return true;
+	}
+	// В кэш — с состоянием склада после этого плана; прерванный план не кэшируется
+	if (!patterns.interrupted)
+		SolverCache::Store(cachePath, demand, params, UserDataFile::ContentHash(inventoryPath), patterns);
+	return true;
+}
+
+CuttingStock::SweepResult RunParameterSweep(double extraLenMM, CuttingStock::SolverMode mode, const CuttingStock::SweepSpec& spec)
+{
+	// Те же входные данные, что у RunCuttingPlan; план не экспортируется и склад не меняется
+	CuttingJob::Job job;
+	if (!BuildSelectionJob(0.0, extraLenMM, mode, job))
+		return CuttingStock::SweepResult();
+	LoadOffcutStock(OffcutInventory::DefaultPath(), job);
+	CuttingStock::SolveControl control;
+	control.timeLimitMs = job.timeLimitMs;   // на всю сетку
+	const CuttingStock::SweepResult result = CuttingStock::Sweep(job, spec, control);
+	if (result.tooLarge)
+		ACAPI_WriteReport("Parameter sweep grid is too large. Increase the steps or narrow the ranges.", true);
+	return result;
 }
 
 } // namespace CutPlanBoardHelper
@@ -5,7 +5,9 @@
 #include "ACAPinc.h"
 #include "GSRoot.hpp"
 #include "CuttingStockSolver.hpp"
+#include "CuttingStockSweep.hpp"
 #include "FastProduction.hpp"
+#include "FastProductionExport.hpp"
 
 namespace CutPlanBoardHelper {
 
@@ -30,8 +32,11 @@ struct ArchiFrameSummaryRow {
 bool IsArchiFramePlank(const API_Guid& guid);
 bool GetArchiFramePlankParams(const API_Guid& guid, ArchiFramePlankParams& out);
 
-GS::Array<CuttingStock::Part> CollectPartsFromSelection(double& outMaxStockLength);
+// Спрос из выделения (одинаковые доски — одной строкой); outStockTypes — различные заготовки (iMaxLen) по ширинам
+CuttingStock::DemandSet CollectDemandFromSelection(std::vector<CuttingStock::StockType>& outStockTypes);
 GS::Array<ArchiFrameSummaryRow> CollectArchiFrameSummaryFromSelection();
+// Сечения выделения (толщина, ширина) для сводок и инструкций экспорта
+std::vector<FastProduction::SectionRow> CollectSectionsFromSelection();
 
 CuttingStock::SolverParams DefaultSolverParams();
 
@@ -46,7 +51,17 @@ bool PlaceScenarioTextOnFloor(const GS::UniString& instructionsTxt, short floorI
 // slitMM      — толщина пилы, мм (если <= 0, используется значение по умолчанию)
 // extraLenMM  — допуск по длине доски, мм (сколько можно «добавить» к iMaxLen при расчёте)
 // floorIndex  — пока заглушка, для будущего размещения объектов на этаже
-bool RunCuttingPlan(double slitMM, double extraLenMM, short floorIndex);
+// mode        — алгоритм раскроя (Greedy по умолчанию, ColumnGeneration или SequentialValueCorrection — для больших групп)
+// saveJob     — записать рядом с CSV задание <имя>_job.apjob (входные данные для Tools/JobRunner); план решается заново, без кэша
+// stationCount — пил на участке: сценарии распределяются по ним, у каждой свой <имя>_station<k>_set_list.csv
+// usefulMinMM, wasteMaxMM — A и B, мм (< 0 — значение DefaultSolverParams); strictAB — остаток не между B и A
+bool RunCuttingPlan(double slitMM, double extraLenMM, short floorIndex,
+	CuttingStock::SolverMode mode = CuttingStock::SolverMode::Greedy, bool saveJob = false, Int32 stationCount = 1,
+	double usefulMinMM = -1.0, double wasteMaxMM = -1.0, bool strictAB = false);
+
+// Подбор параметров на выделении: сетка spec (пустой список — значение RunCuttingPlan) с теми же заготовками
+// и складом остатков; ничего не экспортирует. Фронт Парето — в result.front
+CuttingStock::SweepResult RunParameterSweep(double extraLenMM, CuttingStock::SolverMode mode, const CuttingStock::SweepSpec& spec);
 
 // Выводит в отчёт Archicad все AddPar (имя, тип, значение) для выбранных ArchiFramePlank.
 // Полезно для определения реальных имён параметров в GDL (iHeight, iWidth и т.д.).
@@ -0,0 +1,89 @@
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+
+// Нижние оценки числа заготовок для одной ширины.
+// Пропил учитывается как в остальных частях решателя: вес детали = length + slit,
+// ёмкость = L - trimLoss + slit. При нескольких типах берётся наибольшая ёмкость —
+// оценка числа досок остаётся верной.
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+static Int32 CeilDiv(long long a, long long b)
+{
+	if (a <= 0) return 0;
+	return static_cast<Int32>((a + b - 1) / b);
+}
+
+} // anonymous
+
+LowerBounds ComputeLowerBounds(std::vector<BoundItem> items, Int32 capacity)
+{
+	LowerBounds lb = { 0, 0 };
+	if (capacity <= 0) return lb;
+
+	items.erase(std::remove_if(items.begin(), items.end(), [capacity](const BoundItem& it) {
+		return it.count <= 0 || it.weight <= 0 || it.weight > capacity;
+	}), items.end());
+	if (items.empty()) return lb;
+	std::sort(items.begin(), items.end(), [](const BoundItem& a, const BoundItem& b) { return a.weight > b.weight; });
+
+	// L1: непрерывная оценка
+	long long total = 0;
+	for (const BoundItem& it : items) total += static_cast<long long>(it.weight) * it.count;
+	lb.l1 = CeilDiv(total, capacity);
+
+	// L2 (Martello–Toth): для каждого порога α <= C/2
+	//   J1 = {w > C-α}, J2 = {C-α >= w > C/2}, J3 = {C/2 >= w >= α};
+	//   L(α) = |J1| + |J2| + max(0, ⌈(Σ J3 - (|J2|·C - Σ J2)) / C⌉)
+	std::vector<Int32> alphas = { 0 };
+	for (const BoundItem& it : items) {
+		if (2LL * it.weight <= capacity && it.weight != alphas.back())
+			alphas.push_back(it.weight);
+	}
+	for (Int32 alpha : alphas) {
+		long long n12 = 0, n2 = 0, sum2 = 0, sum3 = 0;
+		for (const BoundItem& it : items) {
+			if (it.weight > capacity - alpha) {
+				n12 += it.count;
+			} else if (2LL * it.weight > capacity) {
+				n12 += it.count;
+				n2 += it.count;
+				sum2 += static_cast<long long>(it.weight) * it.count;
+			} else if (it.weight >= alpha) {
+				sum3 += static_cast<long long>(it.weight) * it.count;
+			}
+		}
+		const Int32 l = static_cast<Int32>(n12) + CeilDiv(sum3 - (n2 * capacity - sum2), capacity);
+		lb.l2 = std::max(lb.l2, l);
+	}
+	return lb;
+}
+
+Int32 MaxCapacityForWidth(const std::vector<StockType>& stock, double boardW, const SolverParams& params)
+{
+	const Int32 slit = std::max(ToMM(params.slit), 0);
+	const Int32 trimLoss = std::max(ToMM(params.trimLoss), 0);
+	Int32 capacity = 0;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		if (StockFitsWidth(stock[t], boardW) && stock[t].available != 0)
+			capacity = std::max(capacity, ToMM(stock[t].length) - trimLoss + slit);
+	}
+	return capacity;
+}
+
+bool BoardCountIsObjective(const std::vector<StockType>& stock, double boardW)
+{
+	double cost = -1.0;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		if (!StockFitsWidth(stock[t], boardW) || stock[t].available == 0) continue;
+		if (cost >= 0.0 && stock[t].cost != cost) return false;
+		cost = stock[t].cost;
+	}
+	return true;
+}
+
+} // namespace Internal
+} // namespace CuttingStock
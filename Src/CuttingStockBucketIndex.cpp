@@ -0,0 +1,107 @@
+#include "CuttingStockBucketIndex.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace CuttingStock {
+namespace Internal {
+
+BucketIndex::BucketIndex(Int32 maxFree) :
+	maxFree(std::max<Int32>(maxFree, 0)),
+	buckets(static_cast<size_t>(std::max<Int32>(maxFree, 0)) + 1)
+{
+	size_t bits = buckets.size();
+	do {
+		const size_t words = (bits + 63) / 64;
+		levels.push_back(std::vector<uint64_t>(words, 0));
+		bits = words;
+	} while (bits > 1);
+}
+
+void BucketIndex::SetBit(size_t pos)
+{
+	for (size_t lv = 0; lv < levels.size(); ++lv) {
+		uint64_t& word = levels[lv][pos / 64];
+		const bool wasEmpty = (word == 0);
+		word |= uint64_t(1) << (pos % 64);
+		if (!wasEmpty) return;
+		pos /= 64;
+	}
+}
+
+void BucketIndex::ClearBit(size_t pos)
+{
+	for (size_t lv = 0; lv < levels.size(); ++lv) {
+		uint64_t& word = levels[lv][pos / 64];
+		word &= ~(uint64_t(1) << (pos % 64));
+		if (word != 0) return;
+		pos /= 64;
+	}
+}
+
+// Позиция первого установленного бита >= pos на уровне level; -1 — нет
+Int64 BucketIndex::NextSet(size_t level, size_t pos) const
+{
+	const std::vector<uint64_t>& bits = levels[level];
+	size_t word = pos / 64;
+	if (word >= bits.size()) return -1;
+
+	const uint64_t masked = bits[word] & (~uint64_t(0) << (pos % 64));
+	if (masked != 0)
+		return static_cast<Int64>(word * 64 + std::countr_zero(masked));
+
+	// Следующее непустое слово ищем уровнем выше
+	if (level + 1 == levels.size()) {
+		for (++word; word < bits.size(); ++word) {
+			if (bits[word] != 0)
+				return static_cast<Int64>(word * 64 + std::countr_zero(bits[word]));
+		}
+		return -1;
+	}
+	const Int64 nextWord = NextSet(level + 1, word + 1);
+	if (nextWord < 0) return -1;
+	return nextWord * 64 + std::countr_zero(bits[static_cast<size_t>(nextWord)]);
+}
+
+void BucketIndex::Insert(Int32 freeLen, UInt32 board)
+{
+	std::vector<UInt32>& heap = buckets[static_cast<size_t>(freeLen)];
+	heap.push_back(board);
+	std::push_heap(heap.begin(), heap.end(), std::greater<UInt32>());
+	if (heap.size() == 1)
+		SetBit(static_cast<size_t>(freeLen));
+}
+
+Int32 BucketIndex::FindFirst(Int32 minFree) const
+{
+	if (minFree > maxFree) return -1;
+	const Int64 pos = NextSet(0, static_cast<size_t>(std::max<Int32>(minFree, 0)));
+	return static_cast<Int32>(pos);
+}
+
+UInt32 BucketIndex::Front(Int32 freeLen) const
+{
+	return buckets[static_cast<size_t>(freeLen)].front();
+}
+
+UInt32 BucketIndex::PopFront(Int32 freeLen)
+{
+	std::vector<UInt32>& heap = buckets[static_cast<size_t>(freeLen)];
+	std::pop_heap(heap.begin(), heap.end(), std::greater<UInt32>());
+	const UInt32 board = heap.back();
+	heap.pop_back();
+	if (heap.empty())
+		ClearBit(static_cast<size_t>(freeLen));
+	return board;
+}
+
+void BucketIndex::RetireBelow(Int32 minFree)
+{
+	for (Int32 f = FindFirst(0); f >= 0 && f < minFree; f = FindFirst(f + 1)) {
+		buckets[static_cast<size_t>(f)].clear();
+		ClearBit(static_cast<size_t>(f));
+	}
+}
+
+} // namespace Internal
+} // namespace CuttingStock
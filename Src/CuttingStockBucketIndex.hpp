@@ -0,0 +1,48 @@
+#ifndef CUTTINGSTOCKBUCKETINDEX_HPP
+#define CUTTINGSTOCKBUCKETINDEX_HPP
+
+#include "CuttingStockSolver.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace CuttingStock {
+namespace Internal {
+
+// Открытые заготовки одной ширины, проиндексированные по свободной длине (целые мм).
+// bucket[f] — min-куча индексов заготовок со свободной длиной f (наименьший индекс = открыта раньше),
+// над непустыми корзинами — иерархический битсет: «наименьшая f >= x» за несколько tzcnt.
+class BucketIndex {
+public:
+	explicit BucketIndex(Int32 maxFree);
+
+	/** Добавить заготовку board со свободной длиной freeLen (0 <= freeLen <= maxFree). */
+	void Insert(Int32 freeLen, UInt32 board);
+
+	/** Наименьшая непустая свободная длина >= minFree; -1 — нет. */
+	Int32 FindFirst(Int32 minFree) const;
+
+	/** Заготовка с наименьшим индексом в корзине freeLen (корзина не пуста). */
+	UInt32 Front(Int32 freeLen) const;
+
+	/** Извлечь Front(freeLen). */
+	UInt32 PopFront(Int32 freeLen);
+
+	/** Убрать из индекса все корзины со свободной длиной < minFree (туда уже ничего не поместится). */
+	void RetireBelow(Int32 minFree);
+
+	Int32 MaxFree() const { return maxFree; }
+
+private:
+	Int32 maxFree;
+	std::vector<std::vector<UInt32>> buckets;
+	std::vector<std::vector<uint64_t>> levels;   // levels[0] — по корзинам, levels[k+1] — по словам levels[k]
+
+	void SetBit(size_t pos);
+	void ClearBit(size_t pos);
+	Int64 NextSet(size_t level, size_t pos) const;
+};
+
+} // namespace Internal
+} // namespace CuttingStock
+
+#endif
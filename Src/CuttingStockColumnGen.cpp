@@ -0,0 +1,338 @@
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Column generation (Gilmore–Gomory) для одной ширины boardW:
+//   min Σ c_p x_p   при   Σ a_ip x_p >= d_i,  x_p >= 0,
+// где p — раскрой (pattern) одной заготовки типа t(p) стоимостью c_p, a_ip — число деталей длины i в нём.
+// Новые раскрои ищутся ограниченным рюкзаком по двойственным ценам (один DP на все типы заготовок).
+// Лимиты количества заготовок в LP не входят — их учитывает округление и жадная доупаковка.
+// Длины, заготовки, рюкзак и доупаковка — общие с SVC (PatternGroup, CuttingStockPatternGroup.cpp).
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+const double kEps = 1e-9;
+const double kPriceEps = 1e-6;   // минимальное улучшение reduced cost
+
+struct Pattern {
+	size_t stock = 0;              // индекс в PatternGroup::stocks
+	std::vector<Int32> counts;   // число деталей каждой длины
+
+	bool operator== (const Pattern& o) const { return stock == o.stock && counts == o.counts; }
+};
+
+static Int32 PatternWeight(const Pattern& pattern, const std::vector<PatternItem>& items)
+{
+	Int32 w = 0;
+	for (size_t i = 0; i < pattern.counts.size(); ++i)
+		w += pattern.counts[i] * items[i].weight;
+	return w;
+}
+
+// Рюкзак по двойственным ценам до наибольшей ёмкости (один на все типы заготовок).
+// Для каждого типа заготовки берётся лучший допустимый по остатку вес; возвращается раскрой
+// с минимальной приведённой стоимостью c_t - Σ y_i a_i.
+static bool PriceBestPattern(const std::vector<PatternItem>& items, const std::vector<double>& duals,
+	const PatternGroup& group, PatternKnapsack& knapsack, Pattern& outPattern, double& outReducedCost)
+{
+	std::vector<double> values(items.size());
+	std::vector<Int32> bounds(items.size());
+	for (size_t i = 0; i < items.size(); ++i) {
+		values[i] = std::max(duals[i], 0.0);
+		bounds[i] = items[i].demand;
+	}
+	knapsack.Solve(items, values, bounds, group.maxCapacity);
+
+	// По каждому типу — лучшее значение; при равенстве — больший вес (меньше остаток)
+	Int32 bestW = -1;
+	size_t bestStock = 0;
+	double bestRc = 0.0;
+	for (size_t st = 0; st < group.stocks.size(); ++st) {
+		const Int32 stockCap = group.stocks[st].capacity;
+		for (Int32 w = stockCap; w > 0; --w) {
+			// Меньшие веса этого типа уже не дадут rc лучше найденного
+			if (knapsack.BestUpTo(w) < 0.0 || (bestW >= 0 && group.stocks[st].cost - knapsack.BestUpTo(w) >= bestRc - kEps)) break;
+			if (knapsack.Best(w) < 0.0) continue;
+			if (!ValidRemainder(stockCap - w, *group.params)) continue;
+			const double rc = group.stocks[st].cost - knapsack.Best(w);
+			if (bestW < 0 || rc < bestRc - kEps) {
+				bestRc = rc;
+				bestW = w;
+				bestStock = st;
+			}
+		}
+	}
+	if (bestW <= 0)
+		return false;
+
+	outPattern.stock = bestStock;
+	knapsack.Counts(bestW, outPattern.counts);
+	outReducedCost = bestRc;
+	return true;
+}
+
+// LP-релаксация на пуле раскроев: ревизованный симплекс с явной B^-1.
+// Стартовый базис — однородные раскрои (диагональная матрица), он допустим.
+// Столбцы избытка (-e_i) входят в базис, если двойственная цена станет отрицательной.
+static void SolveMasterLP(const std::vector<PatternItem>& items, const PatternGroup& group, const SolveContext& solve,
+	std::vector<Pattern>& pool, std::vector<double>& outX)
+{
+	const size_t m = items.size();
+	std::vector<double> binv(m * m, 0.0);
+	std::vector<double> xB(m, 0.0);
+	std::vector<long> basis(m);          // >= 0: индекс в pool, < 0: избыток строки (-1 - i)
+
+	for (size_t i = 0; i < m; ++i) {
+		const double k = static_cast<double>(pool[i].counts[i]);
+		binv[i * m + i] = 1.0 / k;
+		xB[i] = items[i].demand / k;
+		basis[i] = static_cast<long>(i);
+	}
+
+	std::vector<char> inBasis(pool.size(), 0);
+	for (size_t i = 0; i < m; ++i) inBasis[i] = 1;
+
+	std::vector<double> y(m);
+	std::vector<double> col(m);
+	std::vector<double> u(m);
+	const size_t maxPivots = 1000 + 50 * m;
+	PatternKnapsack knapsack;
+	// improveTimeMs: дольше LP группы не решается
+	const PhaseBudget budget(group.params->improveTimeMs);
+
+	// Базис допустим на каждой итерации: после лимита времени округляется то, что есть
+	for (size_t pivot = 0; pivot < maxPivots; ++pivot) {
+		if (solve.Stopped() || budget.Expired()) break;
+
+		// y = c_B^T B^-1
+		std::fill(y.begin(), y.end(), 0.0);
+		for (size_t r = 0; r < m; ++r) {
+			if (basis[r] < 0) continue;
+			const double c = group.stocks[pool[basis[r]].stock].cost;
+			const double* row = &binv[r * m];
+			for (size_t j = 0; j < m; ++j) y[j] += c * row[j];
+		}
+
+		// Входящий столбец — наиболее отрицательная приведённая стоимость
+		long entering = 0;
+		bool found = false;
+		double bestRc = -kPriceEps;
+		for (size_t i = 0; i < m; ++i) {
+			if (y[i] < bestRc) {
+				bestRc = y[i];
+				entering = -1 - static_cast<long>(i);
+				found = true;
+			}
+		}
+		for (size_t p = 0; p < pool.size(); ++p) {
+			if (inBasis[p]) continue;
+			double rc = group.stocks[pool[p].stock].cost;
+			for (size_t i = 0; i < m; ++i) rc -= y[i] * pool[p].counts[i];
+			if (rc < bestRc) {
+				bestRc = rc;
+				entering = static_cast<long>(p);
+				found = true;
+			}
+		}
+		if (!found) {
+			Pattern pattern;
+			double reducedCost = 0.0;
+			if (!PriceBestPattern(items, y, group, knapsack, pattern, reducedCost) || reducedCost >= -kPriceEps)
+				break;   // LP оптимальна
+			if (std::find(pool.begin(), pool.end(), pattern) != pool.end())
+				break;   // численный шум — такой раскрой уже есть
+			pool.push_back(pattern);
+			inBasis.push_back(0);
+			entering = static_cast<long>(pool.size() - 1);
+		}
+
+		if (entering >= 0) {
+			for (size_t i = 0; i < m; ++i) col[i] = pool[entering].counts[i];
+		} else {
+			std::fill(col.begin(), col.end(), 0.0);
+			col[static_cast<size_t>(-1 - entering)] = -1.0;
+		}
+		for (size_t r = 0; r < m; ++r) {
+			double s = 0.0;
+			const double* row = &binv[r * m];
+			for (size_t j = 0; j < m; ++j) s += row[j] * col[j];
+			u[r] = s;
+		}
+
+		// Тест отношений; при равенстве — больший опорный элемент
+		size_t leave = m;
+		double bestRatio = 0.0;
+		for (size_t r = 0; r < m; ++r) {
+			if (u[r] <= kEps) continue;
+			const double ratio = std::max(xB[r], 0.0) / u[r];
+			if (leave == m || ratio < bestRatio - kEps || (ratio < bestRatio + kEps && u[r] > u[leave])) {
+				leave = r;
+				bestRatio = ratio;
+			}
+		}
+		if (leave == m)
+			break;
+
+		const double theta = bestRatio;
+		for (size_t r = 0; r < m; ++r) xB[r] -= theta * u[r];
+		xB[leave] = theta;
+
+		const double piv = u[leave];
+		double* prow = &binv[leave * m];
+		for (size_t j = 0; j < m; ++j) prow[j] /= piv;
+		for (size_t r = 0; r < m; ++r) {
+			if (r == leave || std::fabs(u[r]) <= 0.0) continue;
+			double* row = &binv[r * m];
+			const double f = u[r];
+			for (size_t j = 0; j < m; ++j) row[j] -= f * prow[j];
+		}
+
+		if (basis[leave] >= 0) inBasis[basis[leave]] = 0;
+		basis[leave] = entering;
+		if (entering >= 0) inBasis[entering] = 1;
+	}
+
+	outX.assign(pool.size(), 0.0);
+	for (size_t r = 0; r < m; ++r) {
+		if (basis[r] >= 0)
+			outX[basis[r]] = std::max(xB[r], 0.0);
+	}
+}
+
+// Однородный раскрой с максимальным числом деталей и допустимым остатком; 0 — такого нет.
+static Int32 HomogeneousCount(const PatternItem& item, Int32 capacity, const SolverParams& params)
+{
+	for (Int32 k = capacity / item.weight; k > 0; --k) {
+		if (ValidRemainder(capacity - k * item.weight, params))
+			return k;
+	}
+	return 0;
+}
+
+// LP, округление вниз и добор дробных раскроев без перепроизводства.
+// Детали, не покрытые целочисленным планом, возвращаются в residual группы.
+static void SolveGroup(PatternGroup& group, const SolveContext& solve, PlanResult& result)
+{
+	// Стартовый однородный раскрой — тип с наименьшей ценой на деталь.
+	// Длины без допустимого однородного раскроя (strictAB) оставляем жадному алгоритму.
+	std::vector<PatternItem> lpItems;
+	std::vector<Pattern> homogeneous;
+	for (const PatternItem& it : group.items) {
+		Pattern h = { 0, {} };
+		double bestCost = 0.0;
+		Int32 bestK = 0;
+		for (size_t st = 0; st < group.stocks.size(); ++st) {
+			const Int32 k = HomogeneousCount(it, group.stocks[st].capacity, *group.params);
+			if (k == 0) continue;
+			const double perPiece = group.stocks[st].cost / k;
+			if (bestK == 0 || perPiece < bestCost) {
+				bestK = k;
+				bestCost = perPiece;
+				h.stock = st;
+			}
+		}
+		if (bestK == 0) {
+			AddResidual(group, it, 0);
+			continue;
+		}
+		lpItems.push_back(it);
+		h.counts.push_back(bestK);   // позиция уточняется ниже
+		homogeneous.push_back(h);
+	}
+	if (lpItems.empty())
+		return;
+
+	const size_t m = lpItems.size();
+	std::vector<Pattern> pool;
+	for (size_t i = 0; i < m; ++i) {
+		Pattern p = { homogeneous[i].stock, std::vector<Int32>(m, 0) };
+		p.counts[i] = homogeneous[i].counts[0];
+		pool.push_back(p);
+	}
+
+	std::vector<double> x;
+	SolveMasterLP(lpItems, group, solve, pool, x);
+	if (solve.Stopped()) {
+		// Недорешённый LP округляется хуже жадного алгоритма — группа целиком уходит в доупаковку
+		for (const PatternItem& it : lpItems) AddResidual(group, it, 0);
+		return;
+	}
+
+	std::vector<Int32> left(m);
+	for (size_t i = 0; i < m; ++i) left[i] = lpItems[i].demand;
+
+	std::vector<size_t> order;
+	for (size_t p = 0; p < pool.size(); ++p) {
+		if (x[p] > kEps) order.push_back(p);
+	}
+	std::stable_sort(order.begin(), order.end(), [&x](size_t a, size_t b) { return x[a] > x[b]; });
+
+	auto fitsFully = [&](const Pattern& pattern) {
+		if (group.stocks[pattern.stock].left == 0) return false;
+		for (size_t i = 0; i < m; ++i) {
+			if (pattern.counts[i] > left[i]) return false;
+		}
+		return true;
+	};
+	auto take = [&](const Pattern& pattern) {
+		for (size_t i = 0; i < m; ++i) left[i] -= pattern.counts[i];
+		AddPatternBoards(group, lpItems, pattern.counts, pattern.stock, 1, result);
+	};
+
+	// Округление вниз; раскрой, переросший спрос, урезается до допустимого остатка
+	for (size_t p : order) {
+		Int32 copies = static_cast<Int32>(std::floor(x[p] + 1e-7));
+		for (; copies > 0; --copies) {
+			if (group.stocks[pool[p].stock].left == 0)
+				break;
+			if (fitsFully(pool[p])) {
+				take(pool[p]);
+				continue;
+			}
+			Pattern trimmed = { pool[p].stock, std::vector<Int32>(m, 0) };
+			bool any = false;
+			for (size_t i = 0; i < m; ++i) {
+				trimmed.counts[i] = std::min(pool[p].counts[i], left[i]);
+				any = any || trimmed.counts[i] > 0;
+			}
+			const Int32 cap = group.stocks[trimmed.stock].capacity;
+			if (!any || !ValidRemainder(cap - PatternWeight(trimmed, lpItems), *group.params))
+				break;
+			take(trimmed);
+		}
+	}
+
+	// Дробные части: берём ещё одну копию, если раскрой целиком нужен
+	std::stable_sort(order.begin(), order.end(), [&x](size_t a, size_t b) {
+		return (x[a] - std::floor(x[a])) > (x[b] - std::floor(x[b]));
+	});
+	for (size_t p : order) {
+		const double frac = x[p] - std::floor(x[p] + 1e-7);
+		if (frac > 1e-7 && fitsFully(pool[p]))
+			take(pool[p]);
+	}
+
+	for (size_t i = 0; i < m; ++i)
+		AddResidual(group, lpItems[i], lpItems[i].demand - left[i]);
+}
+
+} // anonymous
+
+PlanResult SolveColumnGeneration(const DemandSet& demand, const SolverParams& params, const SolveContext& solve)
+{
+	PlanResult result;
+	if (demand.items.empty()) return result;
+
+	PatternGroup group = BuildPatternGroup(demand, params);
+	if (!group.items.empty())
+		SolveGroup(group, solve, result);
+	FinishPatternGroup(group, result);
+	return result;
+}
+
+} // namespace Internal
+} // namespace CuttingStock
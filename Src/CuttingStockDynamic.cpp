@@ -0,0 +1,439 @@
+#include "CuttingStockDynamic.hpp"
+#include "CuttingStockInternal.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace CuttingStock {
+
+namespace {
+
+// Сколько самых свободных досок группы перепаковывается при локальной починке
+const size_t kRepairBoards = 8;
+// Отход в доске хуже любого недогруза (как W3 жадного алгоритма)
+const Int32 kWastePenalty = 5000;
+
+static void InsertSorted(std::vector<Int32>& cuts, Int32 lengthMM)
+{
+	cuts.insert(std::upper_bound(cuts.begin(), cuts.end(), lengthMM, [](Int32 a, Int32 b) { return a > b; }), lengthMM);
+}
+
+} // anonymous
+
+DynamicPlan::DynamicPlan(const DemandSet& initialDemand, const SolverParams& solverParams) :
+	demand(initialDemand),
+	params(solverParams),
+	stock(Internal::ResolveStockTypes(solverParams)),
+	slit(std::max(Internal::ToMM(solverParams.slit), 0)),
+	trimLoss(std::max(Internal::ToMM(solverParams.trimLoss), 0))
+{
+	stockUsed.assign(stock.size(), 0);
+	const PatternResult solved = Solve(demand, params);
+	for (size_t p = 0; p < solved.patterns.size(); ++p) {
+		const CutPattern& cp = solved.patterns[p];
+		Board b;
+		b.boardW = cp.boardW;
+		b.widthKey = SizeKey(cp.boardW);
+		b.materialId = cp.materialId;
+		b.stockType = cp.stockType;
+		b.stockLength = cp.stockLength;
+		b.capacity = Internal::ToMM(cp.stockLength) - trimLoss + slit;
+		for (size_t c = 0; c < cp.cutsMM.size(); ++c) b.cuts.push_back(cp.cutsMM[c]);
+		std::sort(b.cuts.begin(), b.cuts.end(), [](Int32 x, Int32 y) { return x > y; });
+		b.changed = false;
+		for (Int32 k = 0; k < cp.count; ++k) {
+			b.id = nextId++;
+			boards.push_back(b);
+			stockUsed[cp.stockType] += 1;
+		}
+	}
+	for (size_t i = 0; i < solved.remaining.size(); ++i) remaining.push_back(solved.remaining[i]);
+	firstNewId = nextId;
+}
+
+Int32 DynamicPlan::GroupMaterial(UInt32 materialId) const
+{
+	return params.groupByMaterial ? static_cast<Int32>(materialId) : -1;
+}
+
+bool DynamicPlan::InGroup(const Board& b, Int64 widthKey, Int32 groupMaterial) const
+{
+	return b.widthKey == widthKey && b.materialId == groupMaterial;
+}
+
+// Как при полном решении: заготовка с материалом — только для группы этого материала
+bool DynamicPlan::StockFitsGroup(const StockType& st, double boardW, Int32 groupMaterial) const
+{
+	if (!Internal::StockFitsWidth(st, boardW)) return false;
+	if (st.material.empty()) return true;
+	return groupMaterial >= 0 && static_cast<size_t>(groupMaterial) < demand.materials.size() &&
+		demand.materials[groupMaterial] == st.material;
+}
+
+Int32 DynamicPlan::Free(const Board& b) const
+{
+	Int32 free = b.capacity;
+	for (Int32 len : b.cuts) free -= len + slit;
+	return free;
+}
+
+// Доски группы, самые свободные — первыми
+std::vector<size_t> DynamicPlan::GroupBoards(double boardW, Int32 groupMaterial) const
+{
+	const Int64 widthKey = SizeKey(boardW);
+	std::vector<size_t> group;
+	std::vector<Int32> free;
+	for (size_t b = 0; b < boards.size(); ++b) {
+		if (InGroup(boards[b], widthKey, groupMaterial)) group.push_back(b);
+	}
+	free.resize(boards.size(), 0);
+	for (size_t b : group) free[b] = Free(boards[b]);
+	std::stable_sort(group.begin(), group.end(), [&free](size_t a, size_t b) { return free[a] > free[b]; });
+	return group;
+}
+
+// Детали досок cand и extra — Best Fit Decreasing в те же доски без cand[drop] (drop >= cand.size() — без исключения).
+// Доски, оставшиеся пустыми, убираются. false — не поместилось или недопустимый остаток; план не меняется.
+bool DynamicPlan::Repack(const std::vector<size_t>& cand, const std::vector<Int32>& extra, size_t drop)
+{
+	std::vector<Int32> pool(extra);
+	for (size_t b : cand) pool.insert(pool.end(), boards[b].cuts.begin(), boards[b].cuts.end());
+	std::sort(pool.begin(), pool.end(), [](Int32 x, Int32 y) { return x > y; });
+
+	std::vector<size_t> bins;
+	for (size_t k = 0; k < cand.size(); ++k) {
+		if (k != drop) bins.push_back(cand[k]);
+	}
+	std::vector<Int32> free;
+	for (size_t b : bins) free.push_back(boards[b].capacity);
+	std::vector<std::vector<Int32>> packed(bins.size());
+	for (Int32 len : pool) {
+		const Int32 w = len + slit;
+		size_t best = bins.size();
+		for (size_t k = 0; k < bins.size(); ++k) {
+			if (free[k] >= w && (best == bins.size() || free[k] < free[best])) best = k;
+		}
+		if (best == bins.size()) return false;
+		free[best] -= w;
+		packed[best].push_back(len);
+	}
+	for (size_t k = 0; k < bins.size(); ++k) {
+		if (!packed[k].empty() && !Internal::ValidRemainder(free[k], params)) return false;
+	}
+
+	std::vector<UInt32> emptied;
+	if (drop < cand.size()) emptied.push_back(boards[cand[drop]].id);
+	for (size_t k = 0; k < bins.size(); ++k) {
+		Board& b = boards[bins[k]];
+		if (packed[k].empty()) {
+			emptied.push_back(b.id);
+		} else if (packed[k] != b.cuts) {
+			b.cuts = packed[k];
+			b.changed = true;
+		}
+	}
+	DropBoards(emptied);
+	return true;
+}
+
+void DynamicPlan::DropBoards(const std::vector<UInt32>& ids)
+{
+	if (ids.empty()) return;
+	for (UInt32 id : ids) {
+		if (id < firstNewId) removedIds.push_back(id);
+	}
+	boards.erase(std::remove_if(boards.begin(), boards.end(), [&](const Board& b) {
+		if (std::find(ids.begin(), ids.end(), b.id) == ids.end()) return false;
+		stockUsed[b.stockType] -= 1;
+		return true;
+	}), boards.end());
+}
+
+void DynamicPlan::AddRemaining(Int32 lengthMM, double boardW, UInt32 materialId, Int32 count)
+{
+	for (PartDemand& d : remaining) {
+		if (d.lengthMM == lengthMM && d.materialId == materialId && d.boardW == boardW) {
+			d.count += count;
+			return;
+		}
+	}
+	remaining.push_back({ lengthMM, materialId, boardW, count });
+}
+
+void DynamicPlan::PlacePiece(Int32 lengthMM, double boardW, UInt32 materialId)
+{
+	const Int32 group = GroupMaterial(materialId);
+	const Int64 widthKey = SizeKey(boardW);
+	const Int32 w = lengthMM + slit;
+	const Int32 wasteMax = Internal::ToMM(params.wasteMax);
+
+	// 1. Лучшее место в существующей доске
+	size_t best = boards.size();
+	Int32 bestScore = 0;
+	for (size_t b = 0; b < boards.size(); ++b) {
+		if (!InGroup(boards[b], widthKey, group)) continue;
+		const Int32 rem = Free(boards[b]) - w;
+		if (!Internal::ValidRemainder(rem, params)) continue;
+		const Int32 score = rem + (rem <= wasteMax ? kWastePenalty : 0);
+		if (best == boards.size() || score < bestScore) {
+			best = b;
+			bestScore = score;
+		}
+	}
+	if (best < boards.size()) {
+		InsertSorted(boards[best].cuts, lengthMM);
+		boards[best].changed = true;
+		return;
+	}
+
+	// 2. Перепаковка самых свободных досок группы вместе с новой деталью
+	std::vector<size_t> cand = GroupBoards(boardW, group);
+	if (cand.size() > kRepairBoards) cand.resize(kRepairBoards);
+	if (!cand.empty() && Repack(cand, { lengthMM }, cand.size()))
+		return;
+
+	// 3. Новая заготовка: наименьшая цена за мм, затем priority
+	Int32 type = -1;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		const StockType& st = stock[t];
+		if (!StockFitsGroup(st, boardW, group) || lengthMM + trimLoss > Internal::ToMM(st.length)) continue;
+		if (st.available >= 0 && stockUsed[t] >= st.available) continue;
+		if (type < 0) {
+			type = static_cast<Int32>(t);
+			continue;
+		}
+		const StockType& cur = stock[type];
+		const double a = st.cost / st.length;
+		const double c = cur.cost / cur.length;
+		if (a < c - 1e-12 || (a <= c + 1e-12 && st.priority < cur.priority))
+			type = static_cast<Int32>(t);
+	}
+	if (type < 0) {
+		AddRemaining(lengthMM, boardW, materialId, 1);
+		return;
+	}
+	Board nb;
+	nb.id = nextId++;
+	nb.boardW = boardW;
+	nb.widthKey = SizeKey(boardW);
+	nb.materialId = group;
+	nb.stockType = type;
+	nb.stockLength = stock[type].length;
+	nb.capacity = Internal::ToMM(stock[type].length) - trimLoss + slit;
+	nb.cuts.push_back(lengthMM);
+	nb.changed = true;
+	boards.push_back(nb);
+	stockUsed[type] += 1;
+}
+
+// Доска стала свободнее: попробовать освободить одну из самых свободных досок группы,
+// иначе — хотя бы вернуть допустимый остаток (strictAB): перепаковкой, переносом детали
+// или, если не вышло, снять доску и разложить её детали заново через PlacePiece
+void DynamicPlan::RepairAfterRemove(size_t board)
+{
+	const Board& target = boards[board];
+	std::vector<size_t> cand = { board };
+	for (size_t b : GroupBoards(target.boardW, target.materialId)) {
+		if (cand.size() >= kRepairBoards) break;
+		if (b != board) cand.push_back(b);
+	}
+	if (cand.size() >= 2) {
+		// Освобождать первой наименее загруженную
+		std::vector<size_t> order(cand.size());
+		for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+		std::vector<Int32> free;
+		for (size_t b : cand) free.push_back(Free(boards[b]));
+		std::stable_sort(order.begin(), order.end(), [&free](size_t a, size_t b) { return free[a] > free[b]; });
+		for (size_t k : order) {
+			if (Repack(cand, {}, k)) return;
+		}
+	}
+	if (Internal::ValidRemainder(Free(target), params) || Repack(cand, {}, cand.size()) || MoveRepair(board) || target.cuts.size() < 2)
+		return;
+	// PlacePiece кладёт деталь только туда, где остаток допустим, иначе открывает заготовку под одну деталь
+	const Board lost = target;
+	DropBoards({ lost.id });
+	for (Int32 len : lost.cuts)
+		PlacePiece(len, lost.boardW, PieceMaterial(len, lost.boardW, lost.materialId));
+}
+
+// materialId детали доски: в группе без материала — материал любой строки спроса с этой длиной и шириной
+UInt32 DynamicPlan::PieceMaterial(Int32 lengthMM, double boardW, Int32 groupMaterial) const
+{
+	if (groupMaterial >= 0) return static_cast<UInt32>(groupMaterial);
+	const Int64 widthKey = SizeKey(boardW);
+	for (const PartDemand& d : demand.items) {
+		if (d.lengthMM == lengthMM && SizeKey(d.boardW) == widthKey) return d.materialId;
+	}
+	return 0;
+}
+
+// Перенести одну деталь между board и другой доской группы так, чтобы оба остатка стали допустимыми
+bool DynamicPlan::MoveRepair(size_t board)
+{
+	const Int32 free = Free(boards[board]);
+	for (size_t o = 0; o < boards.size(); ++o) {
+		if (o == board || !InGroup(boards[o], boards[board].widthKey, boards[board].materialId)) continue;
+		const Int32 otherFree = Free(boards[o]);
+		for (int dir = 0; dir < 2; ++dir) {
+			Board& from = boards[dir == 0 ? board : o];
+			Board& to = boards[dir == 0 ? o : board];
+			const Int32 fromFree = dir == 0 ? free : otherFree;
+			const Int32 toFree = dir == 0 ? otherFree : free;
+			for (size_t k = 0; k < from.cuts.size(); ++k) {
+				const Int32 w = from.cuts[k] + slit;
+				if (!Internal::ValidRemainder(toFree - w, params)) continue;
+				if (from.cuts.size() > 1 && !Internal::ValidRemainder(fromFree + w, params)) continue;
+				InsertSorted(to.cuts, from.cuts[k]);
+				from.cuts.erase(from.cuts.begin() + k);
+				from.changed = true;
+				to.changed = true;
+				if (from.cuts.empty()) DropBoards({ from.id });
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void DynamicPlan::Insert(double length, const std::string& material, double boardW, Int32 count)
+{
+	if (count <= 0) return;
+	AddDemand(demand, length, material, boardW, count);
+	size_t materialId = 0;
+	while (demand.materials[materialId] != material) ++materialId;
+	const Int32 lengthMM = Internal::ToMM(length);
+	for (Int32 k = 0; k < count; ++k)
+		PlacePiece(lengthMM, boardW, static_cast<UInt32>(materialId));
+}
+
+Int32 DynamicPlan::Remove(double length, const std::string& material, double boardW, Int32 count)
+{
+	const Int32 lengthMM = Internal::ToMM(length);
+	size_t row = 0;
+	for (; row < demand.items.size(); ++row) {
+		const PartDemand& d = demand.items[row];
+		if (d.lengthMM == lengthMM && d.boardW == boardW && demand.materials[d.materialId] == material) break;
+	}
+	if (row == demand.items.size()) return 0;
+	const UInt32 materialId = demand.items[row].materialId;
+	const Int32 group = GroupMaterial(materialId);
+	const Int64 widthKey = SizeKey(boardW);
+	count = std::min(count, demand.items[row].count);
+
+	Int32 removed = 0;
+	bool freedSpace = false;
+	while (removed < count) {
+		// Неразмещённые детали убираются первыми — план не меняется
+		auto rem = std::find_if(remaining.begin(), remaining.end(), [&](const PartDemand& d) {
+			return d.lengthMM == lengthMM && d.materialId == materialId && d.boardW == boardW;
+		});
+		if (rem != remaining.end()) {
+			const Int32 take = std::min(rem->count, count - removed);
+			removed += take;
+			if ((rem->count -= take) == 0) remaining.erase(rem);
+			continue;
+		}
+
+		// Доска группы с этой длиной: сначала те, где остаток останется допустимым, затем с наименьшим числом деталей
+		size_t best = boards.size();
+		bool bestValid = false;
+		for (size_t b = 0; b < boards.size(); ++b) {
+			if (!InGroup(boards[b], widthKey, group)) continue;
+			if (std::find(boards[b].cuts.begin(), boards[b].cuts.end(), lengthMM) == boards[b].cuts.end()) continue;
+			const bool valid = boards[b].cuts.size() == 1 || Internal::ValidRemainder(Free(boards[b]) + lengthMM + slit, params);
+			if (best == boards.size() || (valid && !bestValid) ||
+				(valid == bestValid && boards[b].cuts.size() < boards[best].cuts.size())) {
+				best = b;
+				bestValid = valid;
+			}
+		}
+		if (best == boards.size()) break;
+		Board& b = boards[best];
+		b.cuts.erase(std::find(b.cuts.begin(), b.cuts.end(), lengthMM));
+		b.changed = true;
+		++removed;
+		freedSpace = true;
+		if (b.cuts.empty())
+			DropBoards({ b.id });
+		else
+			RepairAfterRemove(best);
+	}
+
+	PartDemand& d = demand.items[row];
+	d.count -= removed;
+	if (d.count <= 0) demand.items.erase(demand.items.begin() + row);
+
+	// Освободилось место или заготовка — неразмещённые детали группы пробуем ещё раз
+	if (freedSpace) {
+		std::vector<PartDemand> retry;
+		for (size_t i = 0; i < remaining.size();) {
+			const PartDemand& r = remaining[i];
+			if (SizeKey(r.boardW) == widthKey && GroupMaterial(r.materialId) == group) {
+				retry.push_back(r);
+				remaining.erase(remaining.begin() + i);
+			} else {
+				++i;
+			}
+		}
+		for (const PartDemand& r : retry) {
+			for (Int32 k = 0; k < r.count; ++k) PlacePiece(r.lengthMM, r.boardW, r.materialId);
+		}
+	}
+	return removed;
+}
+
+ResultBoard DynamicPlan::ToResultBoard(const Board& b) const
+{
+	ResultBoard rb;
+	rb.boardW = b.boardW;
+	rb.stockType = b.stockType;
+	rb.stockLength = b.stockLength;
+	rb.materialId = b.materialId;
+	rb.firstCut = 0;
+	rb.cutCount = static_cast<UInt32>(b.cuts.size());
+	double used = params.trimLoss;
+	for (size_t k = 0; k < b.cuts.size(); ++k) {
+		if (k > 0) used += params.slit;
+		used += b.cuts[k];
+	}
+	rb.remainder = b.stockLength - used;
+	return rb;
+}
+
+SolverResult DynamicPlan::Result() const
+{
+	SolverResult out;
+	for (const Board& b : boards) out.AddBoard(ToResultBoard(b), b.cuts);
+	for (const PartDemand& d : remaining) {
+		for (Int32 k = 0; k < d.count; ++k)
+			out.remaining.push_back({ static_cast<double>(d.lengthMM), demand.materials[d.materialId], d.boardW });
+	}
+	return out;
+}
+
+std::vector<PlanBoard> DynamicPlan::Boards() const
+{
+	std::vector<PlanBoard> out;
+	for (const Board& b : boards) out.push_back({ b.id, ToResultBoard(b), b.cuts });
+	return out;
+}
+
+PlanDelta DynamicPlan::TakeDelta()
+{
+	PlanDelta delta;
+	for (Board& b : boards) {
+		if (b.id >= firstNewId)
+			delta.added.push_back({ b.id, ToResultBoard(b), b.cuts });
+		else if (b.changed)
+			delta.changed.push_back({ b.id, ToResultBoard(b), b.cuts });
+		b.changed = false;
+	}
+	for (UInt32 id : removedIds) delta.removed.push_back(id);
+	for (const PartDemand& d : remaining) delta.remaining.push_back(d);
+	removedIds.clear();
+	firstNewId = nextId;
+	return delta;
+}
+
+} // namespace CuttingStock
@@ -0,0 +1,94 @@
+#ifndef CUTTINGSTOCKDYNAMIC_HPP
+#define CUTTINGSTOCKDYNAMIC_HPP
+
+#include "CuttingStockSolver.hpp"
+#include <vector>
+
+namespace CuttingStock {
+
+// Доска динамического плана; id не меняется, пока доска остаётся в плане.
+struct PlanBoard {
+	UInt32 id;
+	ResultBoard board;          // firstCut = 0: распилы — в cuts
+	std::vector<Int32> cuts;    // мм
+};
+
+// Изменения плана с прошлого TakeDelta.
+struct PlanDelta {
+	std::vector<PlanBoard> added;
+	std::vector<PlanBoard> changed;       // тот же id, другой раскрой
+	std::vector<UInt32> removed;
+	std::vector<PartDemand> remaining;    // весь неразмещённый спрос после изменений
+};
+
+// План раскроя, который правится вслед за моделью без полного пересчёта.
+// Вставка и удаление деталей трогают только доски своей группы (ширина, при groupByMaterial — и материал):
+// деталь кладётся в лучшую подходящую доску, иначе несколько самых свободных досок группы перепаковываются,
+// и только потом открывается новая заготовка. После удаления группа пробует освободить одну доску тем же способом;
+// доска, чей остаток при strictAB так и не стал допустимым, снимается, а её детали вставляются заново.
+class DynamicPlan {
+public:
+	/** Полное решение demand (как Solve); дальше план меняется локально. */
+	DynamicPlan(const DemandSet& demand, const SolverParams& params);
+
+	/** Добавить count деталей. */
+	void Insert(double length, const std::string& material, double boardW, Int32 count = 1);
+
+	/** Убрать до count деталей (сначала из неразмещённых); возвращает, сколько убрано. */
+	Int32 Remove(double length, const std::string& material, double boardW, Int32 count = 1);
+
+	/** Текущий спрос; таблица материалов только растёт, так что materialId досок остаются верными. */
+	const DemandSet& Demand() const { return demand; }
+
+	/** Текущий план; доски — в порядке плана (новые в конце), bounds не пересчитываются. */
+	SolverResult Result() const;
+
+	/** Доски плана с их id. */
+	std::vector<PlanBoard> Boards() const;
+
+	/** Изменения с прошлого вызова (первый вызов — с построения плана). */
+	PlanDelta TakeDelta();
+
+private:
+	struct Board {
+		UInt32 id;
+		double boardW;
+		Int64 widthKey;            // SizeKey(boardW)
+		Int32 materialId;          // материал группы; -1 — группы только по ширине
+		Int32 stockType;
+		double stockLength;
+		Int32 capacity;            // stockLength - trimLoss + slit, мм
+		std::vector<Int32> cuts;   // мм, по убыванию
+		bool changed;
+	};
+
+	DemandSet demand;
+	SolverParams params;
+	std::vector<StockType> stock;
+	std::vector<Int32> stockUsed;
+	std::vector<Board> boards;
+	std::vector<PartDemand> remaining;
+	std::vector<UInt32> removedIds;
+	UInt32 nextId = 0;
+	UInt32 firstNewId = 0;         // доски с id >= firstNewId появились после прошлого TakeDelta
+	Int32 slit;
+	Int32 trimLoss;
+
+	Int32 GroupMaterial(UInt32 materialId) const;
+	bool InGroup(const Board& b, Int64 widthKey, Int32 groupMaterial) const;
+	bool StockFitsGroup(const StockType& st, double boardW, Int32 groupMaterial) const;
+	Int32 Free(const Board& b) const;
+	std::vector<size_t> GroupBoards(double boardW, Int32 groupMaterial) const;
+	bool Repack(const std::vector<size_t>& cand, const std::vector<Int32>& extra, size_t drop);
+	void DropBoards(const std::vector<UInt32>& ids);
+	void PlacePiece(Int32 lengthMM, double boardW, UInt32 materialId);
+	void RepairAfterRemove(size_t board);
+	bool MoveRepair(size_t board);
+	UInt32 PieceMaterial(Int32 lengthMM, double boardW, Int32 groupMaterial) const;
+	void AddRemaining(Int32 lengthMM, double boardW, UInt32 materialId, Int32 count);
+	ResultBoard ToResultBoard(const Board& b) const;
+};
+
+} // namespace CuttingStock
+
+#endif
@@ -0,0 +1,207 @@
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Точный branch-and-bound для малой группы одной ширины (bin packing с пропилом), «bin completion»:
+// доски заполняются по одной; в очередную доску обязательно входит самая длинная из оставшихся деталей,
+// остальное — перебор наборов по длинам (без симметрии одинаковых деталей).
+// Отсечение: доски + L2 на оставшийся спрос >= лучшего плана. Без strictAB перебираются только
+// максимальные наборы (в остаток доски не влезает ни одна оставшаяся деталь); при strictAB
+// остаток каждой доски проверяется, как только доска заполнена.
+// Поиск останавливается на нижней оценке L2 группы или по бюджету узлов/времени.
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+class ExactSearch {
+public:
+	ExactSearch(const std::vector<Int32>& weights, const std::vector<Int32>& counts, Int32 capacity,
+		const SolverParams& params, Int32 upperBound, Int32 lowerBound, const SolveContext& ctx) :
+		w(weights),
+		left(counts),
+		cap(capacity),
+		params(params),
+		strictAB(params.strictAB),
+		best(upperBound),
+		lowerBound(lowerBound),
+		nodeLimit(params.exactNodeLimit),
+		hasDeadline(params.exactTimeMs > 0),
+		deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(params.exactTimeMs)),
+		ctx(ctx),
+		take(weights.size(), 0)
+	{
+	}
+
+	/** true — найден план лучше upperBound. */
+	bool Run()
+	{
+		Search();
+		return !bestBins.empty();
+	}
+
+	bool Exhausted() const { return !aborted; }
+
+	/** Доски лучшего плана: число деталей каждой длины. */
+	const std::vector<std::vector<Int32>>& BestBins() const { return bestBins; }
+
+private:
+	const std::vector<Int32>& w;        // веса длин, по убыванию
+	std::vector<Int32> left;            // оставшийся спрос по длинам
+	const Int32 cap;
+	const SolverParams& params;
+	const bool strictAB;
+	Int32 best;
+	const Int32 lowerBound;
+	const Int32 nodeLimit;
+	const bool hasDeadline;
+	const std::chrono::steady_clock::time_point deadline;
+	const SolveContext& ctx;
+	std::vector<Int32> take;                     // набор для текущей доски
+	std::vector<std::vector<Int32>> bins;        // текущий частичный план
+	std::vector<std::vector<Int32>> bestBins;
+	Int32 nodes = 0;
+	bool aborted = false;
+
+	bool Stop()
+	{
+		if (aborted || best <= lowerBound) return true;
+		if (++nodes > nodeLimit) aborted = true;
+		else if ((nodes & 255) == 0 && ((hasDeadline && std::chrono::steady_clock::now() >= deadline) || ctx.Stopped())) aborted = true;
+		return aborted;
+	}
+
+	Int32 RemainingBound() const
+	{
+		std::vector<BoundItem> items;
+		for (size_t t = 0; t < w.size(); ++t) {
+			if (left[t] > 0) items.push_back({ w[t], left[t] });
+		}
+		return ComputeLowerBounds(items, cap).l2;
+	}
+
+	void Search()
+	{
+		if (Stop()) return;
+
+		size_t first = 0;
+		while (first < w.size() && left[first] == 0) ++first;
+		if (first == w.size()) {
+			if (static_cast<Int32>(bins.size()) < best) {
+				best = static_cast<Int32>(bins.size());
+				bestBins = bins;
+			}
+			return;
+		}
+		if (static_cast<Int32>(bins.size()) + RemainingBound() >= best) return;
+
+		// Самая длинная деталь — в новую доску, остальное дополняется перебором
+		const std::vector<Int32> outer = take;
+		left[first] -= 1;
+		std::fill(take.begin(), take.end(), 0);
+		take[first] = 1;
+		Complete(first, cap - w[first]);
+		left[first] += 1;
+		take = outer;
+	}
+
+	// Дополнить текущую доску длинами t..; free — свободное место
+	void Complete(size_t t, Int32 free)
+	{
+		if (aborted) return;
+		while (t < w.size() && (left[t] == 0 || w[t] > free)) ++t;
+		if (t == w.size()) {
+			if (!ValidRemainder(free, params)) return;
+			if (!strictAB) {
+				// Не максимальный набор доминируется набором с ещё одной деталью
+				for (size_t u = 0; u < w.size(); ++u) {
+					if (left[u] > 0 && w[u] <= free) return;
+				}
+			}
+			bins.push_back(take);
+			Search();
+			bins.pop_back();
+			return;
+		}
+
+		const Int32 most = std::min(left[t], free / w[t]);
+		for (Int32 q = most; q >= 0; --q) {
+			left[t] -= q;
+			take[t] += q;
+			Complete(t + 1, free - q * w[t]);
+			take[t] -= q;
+			left[t] += q;
+			if (aborted || best <= lowerBound) return;
+		}
+	}
+};
+
+} // anonymous
+
+bool SolveExact(const DemandSet& demand, const SolverParams& params, double boardW, Int32 stockType,
+	Int32 upperBound, Int32 lowerBound, const SolveContext& ctx, PlanResult& out, bool& provenOptimal)
+{
+	provenOptimal = false;
+	const std::vector<StockType> stock = ResolveStockTypes(params);
+	if (stockType < 0 || static_cast<size_t>(stockType) >= stock.size()) return false;
+
+	const Int32 slit = std::max(ToMM(params.slit), 0);
+	const Int32 trimLoss = std::max(ToMM(params.trimLoss), 0);
+	const Int32 capacity = ToMM(stock[stockType].length) - trimLoss + slit;
+
+	// Спрос по различным длинам, по убыванию
+	std::vector<Int32> lengths;
+	std::vector<Int32> counts;
+	std::vector<size_t> order;
+	for (size_t i = 0; i < demand.items.size(); ++i) order.push_back(i);
+	std::stable_sort(order.begin(), order.end(), [&demand](size_t a, size_t b) { return demand.items[a].lengthMM > demand.items[b].lengthMM; });
+	for (size_t i : order) {
+		const PartDemand& d = demand.items[i];
+		if (d.count <= 0) continue;
+		if (d.lengthMM + slit > capacity || d.lengthMM <= 0) return false;
+		if (lengths.empty() || lengths.back() != d.lengthMM) {
+			lengths.push_back(d.lengthMM);
+			counts.push_back(0);
+		}
+		counts.back() += d.count;
+	}
+	std::vector<Int32> weights;
+	for (Int32 len : lengths) weights.push_back(len + slit);
+
+	ExactSearch search(weights, counts, capacity, params, upperBound, lowerBound, ctx);
+	const bool improved = search.Run();
+	provenOptimal = search.Exhausted();
+	if (!improved) return false;
+
+	std::vector<std::vector<Int32>> bins;
+	for (const std::vector<Int32>& take : search.BestBins()) {
+		std::vector<Int32> cuts;
+		for (size_t t = 0; t < take.size(); ++t) {
+			for (Int32 k = 0; k < take[t]; ++k) cuts.push_back(lengths[t]);
+		}
+		bins.push_back(cuts);
+	}
+
+	out.boards.clear();
+	out.cuts.clear();
+	for (const std::vector<Int32>& cuts : bins) {
+		ResultBoard rb;
+		rb.boardW = boardW;
+		rb.stockType = stockType;
+		rb.stockLength = stock[stockType].length;
+		double used = params.trimLoss;
+		for (size_t k = 0; k < cuts.size(); ++k) {
+			if (k > 0) used += params.slit;
+			used += cuts[k];
+		}
+		rb.remainder = rb.stockLength - used;
+		out.AddBoard(rb, cuts);
+	}
+	out.remaining.clear();
+	return true;
+}
+
+} // namespace Internal
+} // namespace CuttingStock
@@ -0,0 +1,479 @@
+#include "CuttingStockInternal.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+// Локальное улучшение готовой раскладки (шаг 4 плана): Move / Swap / 2-opt / Repack.
+// Работает по группам boardW в целых мм; вес детали = length + slit, ёмкость = maxL - trimLoss + slit,
+// остаток заготовки = ёмкость - Σ весов (как в SolveGreedy).
+// Фаза A уменьшает стоимость и число заготовок (потенциал Σ load² строго растёт — зацикливания нет),
+// фаза B переводит отходы (0 < остаток <= B) в полезные остатки / нулевые.
+// Всегда возвращается лучший из найденных планов.
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+struct Piece {
+	Int32 w;          // длина в мм + slit
+	Int32 length;     // мм
+};
+
+struct Board {
+	Int32 cap;            // stockLength - trimLoss + slit
+	Int32 load;
+	Int32 stockType;
+	double stockLength;
+	double cost;
+	std::vector<Piece> pieces;
+};
+
+struct Score {
+	double cost;         // Σ стоимости заготовок
+	size_t boards;
+	size_t violations;   // остаток в запретной зоне (B, A) при strictAB
+	size_t waste;        // 0 < остаток <= B
+	long long load2;     // Σ load², больше — лучше (заготовки плотнее)
+};
+
+static bool IsBetter(const Score& a, const Score& b)
+{
+	if (std::fabs(a.cost - b.cost) > 1e-9) return a.cost < b.cost;
+	if (a.boards != b.boards) return a.boards < b.boards;
+	if (a.violations != b.violations) return a.violations < b.violations;
+	if (a.waste != b.waste) return a.waste < b.waste;
+	return a.load2 > b.load2;
+}
+
+class GroupImprover {
+public:
+	GroupImprover(std::vector<Board>& boards, const SolverParams& params, size_t boardTarget, int& iterLeft,
+		const SolveContext& ctx) :
+		boards(boards),
+		boardTarget(boardTarget),
+		params(params),
+		wasteMax(ToMM(params.wasteMax)),
+		iterLeft(iterLeft),
+		ctx(ctx)
+	{
+	}
+
+	void Run()
+	{
+		std::vector<Board> best = boards;
+		Score bestScore = Evaluate();
+
+		// Фаза A: меньше заготовок (до нижней оценки, если она ограничивает критерий)
+		while (boards.size() > boardTarget && HasBudget()) {
+			if (TryEmptyWeakest() || TryShiftLoad() || TryRepack()) {
+				const Score s = Evaluate();
+				if (IsBetter(s, bestScore)) {
+					best = boards;
+					bestScore = s;
+				}
+				continue;
+			}
+			break;
+		}
+
+		// Фаза B: отходы -> полезные остатки (число заготовок не меняется)
+		boards = best;
+		while (HasBudget() && TryFixWaste()) {
+			const Score s = Evaluate();
+			if (IsBetter(s, bestScore)) {
+				best = boards;
+				bestScore = s;
+			}
+		}
+		boards = best;
+	}
+
+private:
+	std::vector<Board>& boards;
+	const size_t boardTarget;   // фаза A останавливается на этом числе досок
+	const SolverParams& params;
+	const Int32 wasteMax;
+	int& iterLeft;
+	const SolveContext& ctx;
+
+	bool HasBudget()
+	{
+		if (iterLeft <= 0) return false;
+		if (ctx.ImproveExpired() || ctx.Stopped()) {
+			iterLeft = 0;
+			return false;
+		}
+		return true;
+	}
+
+	bool Spend()
+	{
+		if (!HasBudget()) return false;
+		--iterLeft;
+		return true;
+	}
+
+	bool IsViolation(Int32 rem) const { return rem >= 0 && !ValidRemainder(rem, params); }
+	bool IsWaste(Int32 rem) const { return rem > 0 && rem <= wasteMax; }
+	Int32 Badness(Int32 rem) const { return (IsViolation(rem) ? 2 : 0) + (IsWaste(rem) ? 1 : 0); }
+
+	Score Evaluate() const
+	{
+		Score s = { 0.0, boards.size(), 0, 0, 0 };
+		for (const Board& b : boards) {
+			s.cost += b.cost;
+			const Int32 rem = b.cap - b.load;
+			if (IsViolation(rem)) ++s.violations;
+			if (IsWaste(rem)) ++s.waste;
+			s.load2 += static_cast<long long>(b.load) * b.load;
+		}
+		return s;
+	}
+
+	std::vector<size_t> WeakestFirst() const
+	{
+		std::vector<size_t> order(boards.size());
+		for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+			return static_cast<long long>(boards[a].load) * boards[b].cap < static_cast<long long>(boards[b].load) * boards[a].cap;
+		});
+		return order;
+	}
+
+	void RemoveBoard(size_t idx)
+	{
+		boards.erase(boards.begin() + static_cast<std::ptrdiff_t>(idx));
+	}
+
+	// Move: разнести все детали самой слабой заготовки по остальным (Best Fit)
+	bool TryEmptyWeakest()
+	{
+		if (boards.size() < 2) return false;
+		const std::vector<size_t> order = WeakestFirst();
+		const size_t maxTargets = std::min<size_t>(order.size(), 8);
+		for (size_t oi = 0; oi < maxTargets; ++oi) {
+			const size_t t = order[oi];
+			if (!Spend()) return false;
+			std::vector<Piece> pieces = boards[t].pieces;
+			std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) { return a.w > b.w; });
+
+			std::vector<Int32> addLoad(boards.size(), 0);
+			std::vector<size_t> target(pieces.size(), boards.size());
+			bool ok = true;
+			for (size_t k = 0; k < pieces.size() && ok; ++k) {
+				size_t bestB = boards.size();
+				Int32 bestFree = 0;
+				for (size_t b = 0; b < boards.size(); ++b) {
+					if (b == t) continue;
+					const Int32 freeSpace = boards[b].cap - boards[b].load - addLoad[b];
+					if (freeSpace < pieces[k].w) continue;
+					if (bestB == boards.size() || freeSpace < bestFree) {
+						bestB = b;
+						bestFree = freeSpace;
+					}
+				}
+				if (bestB == boards.size()) {
+					ok = false;
+				} else {
+					target[k] = bestB;
+					addLoad[bestB] += pieces[k].w;
+				}
+			}
+			if (!ok) continue;
+
+			Int32 violations = 0;
+			for (size_t b = 0; b < boards.size(); ++b) {
+				if (addLoad[b] == 0) continue;
+				violations += IsViolation(boards[b].cap - boards[b].load - addLoad[b]) ? 1 : 0;
+				violations -= IsViolation(boards[b].cap - boards[b].load) ? 1 : 0;
+			}
+			if (violations > 0) continue;
+
+			for (size_t k = 0; k < pieces.size(); ++k) {
+				boards[target[k]].pieces.push_back(pieces[k]);
+				boards[target[k]].load += pieces[k].w;
+			}
+			RemoveBoard(t);
+			return true;
+		}
+		return false;
+	}
+
+	// Swap / 2-opt: обмен до двух деталей слабой заготовки на меньшие (или ни одной) из более полной.
+	// Слабая заготовка разгружается, полная уплотняется — так её проще опустошить на следующем шаге.
+	bool TryShiftLoad()
+	{
+		const std::vector<size_t> order = WeakestFirst();
+		const size_t maxTargets = std::min<size_t>(order.size(), 8);
+		for (size_t oi = 0; oi < maxTargets; ++oi) {
+			const size_t t = order[oi];
+			if (!Spend()) return false;
+			for (size_t bi = order.size(); bi-- > oi + 1;) {
+				const size_t b = order[bi];
+				if (boards[b].load < boards[t].load) continue;
+				if (!HasBudget()) return false;
+				if (TryExchange(t, b))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	struct Subset {
+		Int32 w;
+		size_t i0;
+		size_t i1;   // == size() если деталь одна; оба == size() — пустое множество
+	};
+
+	static std::vector<Subset> Subsets(const std::vector<Piece>& pieces, bool withEmpty)
+	{
+		const size_t n = pieces.size();
+		std::vector<Subset> out;
+		if (withEmpty) out.push_back({ 0, n, n });
+		for (size_t i = 0; i < n; ++i) {
+			out.push_back({ pieces[i].w, i, n });
+			for (size_t j = i + 1; j < n; ++j)
+				out.push_back({ pieces[i].w + pieces[j].w, i, j });
+		}
+		return out;
+	}
+
+	static void TakeSubset(std::vector<Piece>& from, const Subset& s, std::vector<Piece>& out)
+	{
+		const size_t n = from.size();
+		if (s.i1 < n) {
+			out.push_back(from[s.i1]);
+			from.erase(from.begin() + static_cast<std::ptrdiff_t>(s.i1));
+		}
+		if (s.i0 < n) {
+			out.push_back(from[s.i0]);
+			from.erase(from.begin() + static_cast<std::ptrdiff_t>(s.i0));
+		}
+	}
+
+	bool TryExchange(size_t t, size_t b)
+	{
+		Board& bt = boards[t];
+		Board& bb = boards[b];
+		const Int32 freeB = bb.cap - bb.load;
+		const std::vector<Subset> fromT = Subsets(bt.pieces, false);
+		const std::vector<Subset> fromB = Subsets(bb.pieces, true);
+
+		const Int32 badBefore = (IsViolation(bt.cap - bt.load) ? 1 : 0) + (IsViolation(bb.cap - bb.load) ? 1 : 0);
+		Int32 bestDelta = 0;
+		size_t bestP = 0;
+		size_t bestQ = 0;
+		for (size_t p = 0; p < fromT.size(); ++p) {
+			for (size_t q = 0; q < fromB.size(); ++q) {
+				const Int32 delta = fromT[p].w - fromB[q].w;
+				if (delta <= bestDelta || delta > freeB) continue;
+				const Int32 badAfter = (IsViolation(bt.cap - bt.load + delta) ? 1 : 0) + (IsViolation(freeB - delta) ? 1 : 0);
+				if (badAfter > badBefore) continue;
+				bestDelta = delta;
+				bestP = p;
+				bestQ = q;
+			}
+		}
+		if (bestDelta <= 0)
+			return false;
+
+		std::vector<Piece> toB;
+		std::vector<Piece> toT;
+		TakeSubset(bt.pieces, fromT[bestP], toB);
+		TakeSubset(bb.pieces, fromB[bestQ], toT);
+		bt.pieces.insert(bt.pieces.end(), toT.begin(), toT.end());
+		bb.pieces.insert(bb.pieces.end(), toB.begin(), toB.end());
+		bt.load -= bestDelta;
+		bb.load += bestDelta;
+		if (bt.pieces.empty())
+			RemoveBoard(t);
+		return true;
+	}
+
+	// Repack: k самых слабых заготовок переупаковать жадно (BFD) в k-1 из них
+	bool TryRepack()
+	{
+		const std::vector<size_t> order = WeakestFirst();
+		const size_t maxK = std::min<size_t>(order.size(), 8);
+		for (size_t k = 2; k <= maxK; ++k) {
+			if (!Spend()) return false;
+			std::vector<Piece> pieces;
+			for (size_t i = 0; i < k; ++i) {
+				const Board& b = boards[order[i]];
+				pieces.insert(pieces.end(), b.pieces.begin(), b.pieces.end());
+			}
+			std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) { return a.w > b.w; });
+
+			// Ёмкости k-1 самых больших заготовок из набора
+			std::vector<size_t> slots(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k));
+			std::stable_sort(slots.begin(), slots.end(), [this](size_t a, size_t b) { return boards[a].cap > boards[b].cap; });
+			slots.pop_back();
+
+			std::vector<Board> packed;
+			for (size_t s : slots) {
+				const Board& src = boards[s];
+				packed.push_back({ src.cap, 0, src.stockType, src.stockLength, src.cost, {} });
+			}
+			bool ok = true;
+			for (const Piece& pc : pieces) {
+				size_t bestB = packed.size();
+				for (size_t b = 0; b < packed.size(); ++b) {
+					const Int32 freeSpace = packed[b].cap - packed[b].load;
+					if (freeSpace < pc.w) continue;
+					if (bestB == packed.size() || freeSpace < packed[bestB].cap - packed[bestB].load)
+						bestB = b;
+				}
+				if (bestB == packed.size()) { ok = false; break; }
+				packed[bestB].pieces.push_back(pc);
+				packed[bestB].load += pc.w;
+			}
+			if (!ok) continue;
+
+			Int32 violations = 0;
+			for (size_t i = 0; i < k; ++i)
+				violations -= IsViolation(boards[order[i]].cap - boards[order[i]].load) ? 1 : 0;
+			for (const Board& b : packed)
+				violations += IsViolation(b.cap - b.load) ? 1 : 0;
+			if (violations > 0) continue;
+
+			std::vector<size_t> removed(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k));
+			std::sort(removed.begin(), removed.end());
+			for (size_t i = removed.size(); i-- > 0;)
+				RemoveBoard(removed[i]);
+			for (Board& b : packed) {
+				if (!b.pieces.empty())
+					boards.push_back(b);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	// Обмен 1-1 между заготовкой с отходом и любой другой, если суммарная «плохость» остатков падает
+	bool TryFixWaste()
+	{
+		for (size_t a = 0; a < boards.size(); ++a) {
+			const Int32 remA = boards[a].cap - boards[a].load;
+			if (!IsWaste(remA) && !IsViolation(remA)) continue;
+			if (!Spend()) return false;
+			for (size_t b = 0; b < boards.size(); ++b) {
+				if (b == a) continue;
+				if (!HasBudget()) return false;
+				const Int32 remB = boards[b].cap - boards[b].load;
+				const Int32 before = Badness(remA) + Badness(remB);
+				for (size_t p = 0; p < boards[a].pieces.size(); ++p) {
+					for (size_t q = 0; q < boards[b].pieces.size(); ++q) {
+						const Int32 d = boards[a].pieces[p].w - boards[b].pieces[q].w;
+						if (d == 0) continue;
+						const Int32 newA = remA + d;
+						const Int32 newB = remB - d;
+						if (newA < 0 || newB < 0) continue;
+						if (Badness(newA) + Badness(newB) >= before) continue;
+						std::swap(boards[a].pieces[p], boards[b].pieces[q]);
+						boards[a].load -= d;
+						boards[b].load += d;
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+};
+
+} // anonymous
+
+void ImprovePlan(PlanResult& result, const SolverParams& params, const SolveContext& ctx)
+{
+	if (params.maxImproveIter <= 0 || result.boards.size() < 2 || ctx.Stopped())
+		return;
+
+	int iterLeft = params.maxImproveIter;
+
+	const Int32 slit = std::max(ToMM(params.slit), 0);
+	const Int32 trimLoss = std::max(ToMM(params.trimLoss), 0);
+	const std::vector<StockType> stock = ResolveStockTypes(params);
+
+	// Группы boardW; позиции досок группы в result.boards сохраняются
+	std::vector<double> widths;
+	std::vector<std::vector<size_t>> positions;
+	std::unordered_map<Int64, size_t> groupOf;   // SizeKey(boardW) -> группа
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		const auto g = groupOf.emplace(SizeKey(result.boards[b].boardW), widths.size());
+		if (g.second) {
+			widths.push_back(result.boards[b].boardW);
+			positions.push_back({});
+		}
+		positions[g.first->second].push_back(b);
+	}
+
+	std::vector<char> keep(result.boards.size(), 1);
+	for (size_t g = 0; g < widths.size() && iterLeft > 0; ++g) {
+		if (positions[g].size() < 2) continue;
+
+		std::vector<Board> boards;
+		for (size_t pos : positions[g]) {
+			const ResultBoard& rb = result.boards[pos];
+			const double cost = (rb.stockType >= 0 && static_cast<size_t>(rb.stockType) < stock.size()) ? stock[rb.stockType].cost : 1.0;
+			Board b = { ToMM(rb.stockLength) - trimLoss + slit, 0, rb.stockType, rb.stockLength, cost, {} };
+			for (Int32 len : result.Cuts(pos)) {
+				const Piece pc = { len + slit, len };
+				b.pieces.push_back(pc);
+				b.load += pc.w;
+			}
+			boards.push_back(b);
+		}
+
+		// Нижняя оценка: достигнута — уменьшать число досок дальше некуда
+		size_t boardTarget = 0;
+		if (BoardCountIsObjective(stock, widths[g])) {
+			std::vector<BoundItem> items;
+			for (const Board& b : boards) {
+				for (const Piece& pc : b.pieces) items.push_back({ pc.w, 1 });
+			}
+			boardTarget = static_cast<size_t>(ComputeLowerBounds(items, MaxCapacityForWidth(stock, widths[g], params)).l2);
+		}
+
+		GroupImprover(boards, params, boardTarget, iterLeft, ctx).Run();
+
+		for (size_t i = 0; i < positions[g].size(); ++i) {
+			const size_t pos = positions[g][i];
+			if (i >= boards.size()) {
+				keep[pos] = 0;
+				continue;
+			}
+			Board& b = boards[i];
+			std::stable_sort(b.pieces.begin(), b.pieces.end(), [](const Piece& x, const Piece& y) { return x.length > y.length; });
+			// Новый раскрой — в конец cuts; прежний диапазон уберёт сжатие ниже
+			ResultBoard rb;
+			rb.boardW = widths[g];
+			rb.stockType = b.stockType;
+			rb.stockLength = b.stockLength;
+			rb.firstCut = static_cast<UInt32>(result.cuts.size());
+			double used = params.trimLoss;
+			for (size_t k = 0; k < b.pieces.size(); ++k) {
+				if (k > 0) used += params.slit;
+				used += b.pieces[k].length;
+				result.cuts.push_back(b.pieces[k].length);
+			}
+			rb.cutCount = static_cast<UInt32>(result.cuts.size() - rb.firstCut);
+			rb.remainder = b.stockLength - used;
+			result.boards[pos] = rb;
+		}
+	}
+
+	BoardTable compact;
+	compact.boards.reserve(result.boards.size());
+	compact.cuts.reserve(result.cuts.size());
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		if (keep[b]) compact.AddBoard(result.boards[b], result.Cuts(b));
+	}
+	static_cast<BoardTable&>(result) = std::move(compact);
+}
+
+} // namespace Internal
+} // namespace CuttingStock
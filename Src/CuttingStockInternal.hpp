@@ -0,0 +1,215 @@
+#ifndef CUTTINGSTOCKINTERNAL_HPP
+#define CUTTINGSTOCKINTERNAL_HPP
+
+#include "CuttingStockSolver.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Внутренние точки входа решателя, общие для нескольких .cpp.
+// Не для использования за пределами CuttingStock*.cpp.
+
+namespace CuttingStock {
+namespace Internal {
+
+/** Общее состояние одного вызова Solve для всех групп. */
+struct SolveContext {
+	std::chrono::steady_clock::time_point improveDeadline;
+	bool hasImproveDeadline = false;
+	mutable std::atomic<Int64> improvePausedNs{ 0 };   // время CG/SVC групп: не входит в improveTimeMs
+	const CancelToken* cancel = nullptr;
+	std::chrono::steady_clock::time_point deadline;   // SolveControl::timeLimitMs
+	bool hasDeadline = false;
+	mutable std::atomic<bool> stopped{ false };
+
+	/** Отмена или общий дедлайн; после первого true остаётся true. */
+	bool Stopped() const
+	{
+		if (stopped.load(std::memory_order_relaxed)) return true;
+		if ((cancel && cancel->IsCancelled()) || (hasDeadline && std::chrono::steady_clock::now() >= deadline)) {
+			stopped.store(true);
+			return true;
+		}
+		return false;
+	}
+
+	/** Лимит улучшения вышел: improveTimeMs без времени, отданного CG/SVC. */
+	bool ImproveExpired() const
+	{
+		return hasImproveDeadline &&
+			std::chrono::steady_clock::now() >= improveDeadline + std::chrono::nanoseconds(improvePausedNs.load(std::memory_order_relaxed));
+	}
+};
+
+/** Лимит времени фазы одной группы (column generation, проходы SVC): budgetMs от начала фазы; 0 — без лимита. */
+class PhaseBudget {
+public:
+	explicit PhaseBudget(int budgetMs)
+		: limited(budgetMs > 0), end(std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMs > 0 ? budgetMs : 0))
+	{
+	}
+
+	bool Expired() const { return limited && std::chrono::steady_clock::now() >= end; }
+
+private:
+	bool limited;
+	std::chrono::steady_clock::time_point end;
+};
+
+/** Результат группы: доски и неразмещённый спрос (строки с materialId исходного DemandSet). */
+struct PlanResult : BoardTable {
+	std::vector<PartDemand> remaining;
+	std::vector<GroupBound> bounds;
+	bool provenOptimal = false;   // для одной группы: число досок доказано минимальным
+};
+
+/** Детали одной длины для нижней оценки: weight = length + slit, мм. */
+struct BoundItem {
+	Int32 weight;
+	Int32 count;
+};
+
+struct LowerBounds {
+	Int32 l1;
+	Int32 l2;
+};
+
+/** Длина в целых миллиметрах (округление к ближайшему). */
+Int32 ToMM(double value);
+
+/** Остаток remMM допустим: не отрицателен и при strictAB не лежит строго между wasteMax и usefulMin
+ *  (границы — в целых мм, одинаково для всех этапов). */
+bool ValidRemainder(Int32 remMM, const SolverParams& params);
+
+/** Типы заготовок из params; если список пуст — один тип длины maxStockLength. */
+std::vector<StockType> ResolveStockTypes(const SolverParams& params);
+
+/** Подходит ли тип заготовки для ширины boardW. */
+bool StockFitsWidth(const StockType& stock, double boardW);
+
+/** L1 и L2 (Martello–Toth) для деталей одной ширины; детали тяжелее capacity не учитываются. */
+LowerBounds ComputeLowerBounds(std::vector<BoundItem> items, Int32 capacity);
+
+/** Наибольшая ёмкость (length - trimLoss + slit, мм) среди доступных типов для ширины boardW; 0 — нет подходящих. */
+Int32 MaxCapacityForWidth(const std::vector<StockType>& stock, double boardW, const SolverParams& params);
+
+/** Все доступные типы для ширины одной цены — тогда критерий плана только число досок и нижняя оценка его ограничивает. */
+bool BoardCountIsObjective(const std::vector<StockType>& stock, double boardW);
+
+/** Жадный Best-Fit Decreasing по всему спросу (количества раскрываются по одной детали только внутри цикла). */
+PlanResult SolveGreedy(const DemandSet& demand, const SolverParams& params);
+
+/** Длина деталей группы раскроев; weight = length + slit, мм. */
+struct PatternItem {
+	Int32 length;
+	Int32 weight;
+	Int32 demand;
+	std::vector<size_t> sources;   // строки DemandSet этой длины (для материалов и остатка)
+};
+
+/** Тип заготовки, подходящий для ширины группы. */
+struct PatternStock {
+	Int32 type;        // индекс в ResolveStockTypes
+	Int32 capacity;    // length - trimLoss + slit, мм
+	double cost;
+	Int32 priority;
+	Int32 left;        // < 0 — без ограничения
+};
+
+/** Спрос одной ширины для алгоритмов раскроев (column generation, SVC): длины по убыванию,
+ *  подходящие заготовки и детали, оставленные жадной доупаковке. */
+struct PatternGroup {
+	const DemandSet* demand;
+	const SolverParams* params;
+	std::vector<StockType> stock;        // ResolveStockTypes(params)
+	double boardW;
+	Int32 slit;
+	Int32 maxCapacity;                   // наибольшая capacity из stocks
+	std::vector<PatternStock> stocks;
+	std::vector<PatternItem> items;
+	DemandSet residual;                  // доупаковка SolveGreedy
+};
+
+/** Группа по спросу одной ширины (как у SolvePartition); длины, которые не помещаются ни в одну заготовку, сразу в residual. */
+PatternGroup BuildPatternGroup(const DemandSet& demand, const SolverParams& params);
+
+/** Непокрытые детали длины: первые placed штук по строкам sources считаются размещёнными, остальные — в residual. */
+void AddResidual(PatternGroup& group, const PatternItem& item, Int32 placed);
+
+/** copies досок раскроя counts (число деталей каждой из items) на заготовке stocks[stock]; её left уменьшается. */
+void AddPatternBoards(PatternGroup& group, const std::vector<PatternItem>& items, const std::vector<Int32>& counts, size_t stock,
+	Int32 copies, PlanResult& result);
+
+/** residual доупаковывается SolveGreedy на заготовках, оставшихся после раскроев группы. */
+void FinishPatternGroup(PatternGroup& group, PlanResult& result);
+
+/** Ограниченный рюкзак по точному весу до capacity: двоичное разбиение кратностей, выбор — в битовой матрице.
+ *  При равной цене остаётся набор, найденный первым. */
+class PatternKnapsack {
+public:
+	/** values[i] — цена детали items[i], bounds[i] — сколько таких можно взять. */
+	void Solve(const std::vector<PatternItem>& items, const std::vector<double>& values, const std::vector<Int32>& bounds, Int32 capacity);
+
+	/** Наибольшая цена набора веса ровно w (w <= capacity); < 0 — такого набора нет. */
+	double Best(Int32 w) const { return best[static_cast<size_t>(w)]; }
+
+	/** Наибольшая цена набора веса не больше w: перебор весов заготовки вниз можно прекратить, когда и она не лучше. */
+	double BestUpTo(Int32 w) const { return bestUpTo[static_cast<size_t>(w)]; }
+
+	/** Число деталей каждого типа в наборе веса w. */
+	void Counts(Int32 w, std::vector<Int32>& out) const;
+
+private:
+	struct Split {
+		size_t type;
+		Int32 mult;
+		Int32 weight;
+		double value;
+	};
+	std::vector<Split> split;
+	std::vector<double> best;
+	std::vector<double> bestUpTo;
+	std::vector<UInt64> take;
+	size_t rowWords = 0;
+	size_t itemCount = 0;
+};
+
+/** Column generation для спроса одной ширины; остаток после округления доупаковывается SolveGreedy.
+ *  LP решается не дольше improveTimeMs (после лимита округляется текущий допустимый базис).
+ *  При ctx.Stopped() группа без завершённого LP целиком доупаковывается SolveGreedy. */
+PlanResult SolveColumnGeneration(const DemandSet& demand, const SolverParams& params, const SolveContext& ctx);
+
+/** Sequential Value Correction для спроса одной ширины (svcPasses проходов, но новые не начинаются после improveTimeMs
+ *  от начала группы; остаётся лучший); остаток доупаковывается SolveGreedy. При ctx.Stopped() группа без завершённого прохода целиком доупаковывается SolveGreedy. */
+PlanResult SolveValueCorrection(const DemandSet& demand, const SolverParams& params, const SolveContext& ctx);
+
+/** Точный B&B для одной малой группы на заготовках типа stockType: план лучше upperBound досок -> true и out.
+ *  provenOptimal — перебор завершён в пределах exactNodeLimit/exactTimeMs (лучший из планов минимален). */
+bool SolveExact(const DemandSet& demand, const SolverParams& params, double boardW, Int32 stockType,
+	Int32 upperBound, Int32 lowerBound, const SolveContext& ctx, PlanResult& out, bool& provenOptimal);
+
+/** Локальное улучшение (Move/Swap/2-opt/Repack) в пределах maxImproveIter и общего дедлайна. */
+void ImprovePlan(PlanResult& result, const SolverParams& params, const SolveContext& ctx);
+
+/** Сокращение числа различных раскроев без увеличения числа досок (patternReduceIter, patternWasteWeight). */
+void ReducePatterns(PlanResult& result, const SolverParams& params, const SolveContext& ctx);
+
+/** Один спрос при нескольких наборах параметров (Sweep): группы строятся один раз, задачи (набор, группа)
+ *  решаются общим пулом на paramsList[0].threadCount потоках. У наборов должны совпадать groupByMaterial
+ *  и заготовки с точностью до длины. Лимит и отмена control — общие, улучшение — improveTimeMs на набор;
+ *  onProgress считает группы всех наборов. */
+std::vector<PlanResult> SolveDemandBatch(const DemandSet& demand, const std::vector<SolverParams>& paramsList, const SolveControl& control,
+	std::vector<bool>& interrupted);
+
+/** Доски плана — шаблонами с кратностью (порядок — по первому появлению). */
+PatternResult ToPatternResult(const PlanResult& plan, bool interrupted);
+
+/** Выполнить fn(0..count-1) на threadCount потоках (0 — по числу ядер). Исключение из fn пробрасывается. */
+void ParallelFor(size_t count, Int32 threadCount, const std::function<void(size_t)>& fn);
+
+} // namespace Internal
+} // namespace CuttingStock
+
+#endif
@@ -0,0 +1,287 @@
+#include "CuttingStockJob.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace CuttingJob {
+
+namespace {
+
+const char* const kMagic = "ArchPlanksJob";
+
+static const char* ModeName(CuttingStock::SolverMode mode)
+{
+	switch (mode) {
+		case CuttingStock::SolverMode::ColumnGeneration: return "cg";
+		case CuttingStock::SolverMode::SequentialValueCorrection: return "svc";
+		default: return "greedy";
+	}
+}
+
+static bool ParseMode(const std::string& name, CuttingStock::SolverMode& out)
+{
+	if (name == "greedy") { out = CuttingStock::SolverMode::Greedy; return true; }
+	if (name == "cg") { out = CuttingStock::SolverMode::ColumnGeneration; return true; }
+	if (name == "svc") { out = CuttingStock::SolverMode::SequentialValueCorrection; return true; }
+	return false;
+}
+
+static void AppendF(std::string& text, const char* fmt, double a)
+{
+	char buf[64];
+	std::snprintf(buf, sizeof(buf), fmt, a);
+	text += buf;
+}
+
+// " %.17g" — без потерь при обратном чтении
+static void PutNumber(std::string& text, double v)
+{
+	AppendF(text, " %.17g", v);
+}
+
+static void PutValue(std::string& text, const char* key, double v)
+{
+	text += key;
+	PutNumber(text, v);
+	text += "\n";
+}
+
+static void PutStock(std::string& text, const char* key, const CuttingStock::StockType& st)
+{
+	text += key;
+	PutNumber(text, st.length);
+	PutNumber(text, st.cost);
+	PutNumber(text, st.available);
+	PutNumber(text, st.priority);
+	PutNumber(text, st.boardW);
+	if (!st.material.empty()) {
+		text += " ";
+		text += st.material;
+	}
+	text += "\n";
+}
+
+// Разбор строки: числа через пробел, в конце — необязательная строка до конца строки.
+class LineReader {
+public:
+	explicit LineReader(const std::string& line) : p(line.c_str()) {}   // line живёт дольше LineReader
+
+	bool Number(double& v)
+	{
+		char* end = nullptr;
+		v = std::strtod(p, &end);
+		if (end == p) return false;
+		p = end;
+		return true;
+	}
+
+	bool Int(Int32& v)
+	{
+		double d = 0.0;
+		if (!Number(d) || d != static_cast<double>(static_cast<Int32>(d))) return false;
+		v = static_cast<Int32>(d);
+		return true;
+	}
+
+	std::string Rest()
+	{
+		if (*p == ' ') ++p;
+		return std::string(p);
+	}
+
+	bool AtEnd()
+	{
+		while (*p == ' ' || *p == '\t') ++p;
+		return *p == '\0';
+	}
+
+private:
+	const char* p;
+};
+
+static bool ReadStock(LineReader& in, CuttingStock::StockType& st)
+{
+	if (!in.Number(st.length) || !in.Number(st.cost) || !in.Int(st.available) || !in.Int(st.priority) || !in.Number(st.boardW))
+		return false;
+	st.material = in.Rest();
+	return st.length > 0.0;
+}
+
+} // anonymous
+
+CuttingStock::SolverParams SolveParams(const Job& job)
+{
+	CuttingStock::SolverParams out = CuttingStock::ApplyExtraLength(job.params, job.extraLenMM);
+	out.stockTypes.insert(out.stockTypes.end(), job.offcutStock.begin(), job.offcutStock.end());
+	return out;
+}
+
+std::string Write(const Job& job)
+{
+	const CuttingStock::SolverParams& p = job.params;
+	std::string text = kMagic;
+	AppendF(text, " %.0f\n", kFormatVersion);
+	PutValue(text, "slit", p.slit);
+	PutValue(text, "trimLoss", p.trimLoss);
+	PutValue(text, "usefulMin", p.usefulMin);
+	PutValue(text, "wasteMax", p.wasteMax);
+	PutValue(text, "strictAB", p.strictAB ? 1 : 0);
+	PutValue(text, "maxImproveIter", p.maxImproveIter);
+	PutValue(text, "improveTimeMs", p.improveTimeMs);
+	text += "mode ";
+	text += ModeName(p.mode);
+	text += "\n";
+	PutValue(text, "groupByMaterial", p.groupByMaterial ? 1 : 0);
+	PutValue(text, "threadCount", p.threadCount);
+	PutValue(text, "exactNodeLimit", p.exactNodeLimit);
+	PutValue(text, "exactTimeMs", p.exactTimeMs);
+	PutValue(text, "patternReduceIter", p.patternReduceIter);
+	PutValue(text, "patternWasteWeight", p.patternWasteWeight);
+	PutValue(text, "svcPasses", p.svcPasses);
+	PutValue(text, "maxStockLength", p.maxStockLength);
+	PutValue(text, "extraLenMM", job.extraLenMM);
+	PutValue(text, "timeLimitMs", job.timeLimitMs);
+	PutValue(text, "stations", job.stations.count);
+	PutValue(text, "secondsPerCut", job.stations.secondsPerCut);
+	PutValue(text, "secondsPerSetup", job.stations.secondsPerSetup);
+
+	// stock / offcut: длина, цена, доступно, очередность, ширина[, материал]
+	for (size_t i = 0; i < p.stockTypes.size(); ++i)
+		PutStock(text, "stock", p.stockTypes[i]);
+	for (size_t i = 0; i < job.offcutStock.size(); ++i)
+		PutStock(text, "offcut", job.offcutStock[i]);
+
+	// material — в порядке индексов; part: длина мм, количество, индекс материала, ширина
+	for (size_t i = 0; i < job.demand.materials.size(); ++i)
+		text += "material " + job.demand.materials[i] + "\n";
+	for (size_t i = 0; i < job.demand.items.size(); ++i) {
+		const CuttingStock::PartDemand& d = job.demand.items[i];
+		text += "part";
+		PutNumber(text, d.lengthMM);
+		PutNumber(text, d.count);
+		PutNumber(text, d.materialId);
+		PutNumber(text, d.boardW);
+		text += "\n";
+	}
+
+	// section: толщина, ширина, досок, суммарная длина, исходная длина
+	for (size_t i = 0; i < job.sections.size(); ++i) {
+		const FastProduction::SectionRow& s = job.sections[i];
+		text += "section";
+		PutNumber(text, s.thicknessMM);
+		PutNumber(text, s.widthMM);
+		PutNumber(text, s.count);
+		PutNumber(text, s.totalLenMM);
+		PutNumber(text, s.maxLenMM);
+		text += "\n";
+	}
+	return text;
+}
+
+bool Read(const std::string& text, Job& out, std::string& error)
+{
+	out = Job();
+	out.params = {};
+	bool headerSeen = false;
+	size_t lineNo = 0;
+	size_t pos = 0;
+	while (pos < text.size()) {
+		size_t end = text.find('\n', pos);
+		if (end == std::string::npos) end = text.size();
+		std::string line = text.substr(pos, end - pos);
+		pos = end + 1;
+		++lineNo;
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (lineNo == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+			line.erase(0, 3);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		const size_t sp = line.find(' ');
+		const std::string key = line.substr(0, sp);
+		const std::string values = (sp == std::string::npos ? std::string() : line.substr(sp));
+		LineReader in(values);
+		auto fail = [&](const char* what) {
+			error = "line " + std::to_string(lineNo) + ": " + what;
+			return false;
+		};
+
+		if (!headerSeen) {
+			Int32 version = 0;
+			if (key != kMagic || !in.Int(version) || version <= 0)
+				return fail("not a cutting job file");
+			if (static_cast<UInt32>(version) > kFormatVersion)
+				return fail("job format version is newer than supported");
+			headerSeen = true;
+			continue;
+		}
+
+		CuttingStock::SolverParams& p = out.params;
+		double v = 0.0;
+		Int32 n = 0;
+		bool ok = true;
+		if (key == "material") {
+			out.demand.materials.push_back(in.Rest());
+			continue;
+		} else if (key == "mode") {
+			ok = ParseMode(in.Rest(), p.mode);
+		} else if (key == "stock" || key == "offcut") {
+			CuttingStock::StockType st = {};
+			if (!ReadStock(in, st))
+				return fail("bad stock");
+			(key == "stock" ? p.stockTypes : out.offcutStock).push_back(st);
+			continue;
+		} else if (key == "part") {
+			CuttingStock::PartDemand d = {};
+			Int32 materialId = 0;
+			ok = in.Int(d.lengthMM) && in.Int(d.count) && in.Int(materialId) && in.Number(d.boardW) && in.AtEnd() &&
+				d.lengthMM > 0 && d.count > 0 && materialId >= 0 && static_cast<size_t>(materialId) < out.demand.materials.size();
+			if (!ok) return fail("bad part");
+			d.materialId = static_cast<UInt32>(materialId);
+			out.demand.items.push_back(d);
+			continue;
+		} else if (key == "section") {
+			FastProduction::SectionRow s = {};
+			ok = in.Number(s.thicknessMM) && in.Number(s.widthMM) && in.Int(s.count) && in.Number(s.totalLenMM) && in.Number(s.maxLenMM) && in.AtEnd();
+			if (ok) out.sections.push_back(s);
+		} else if (key == "strictAB" || key == "groupByMaterial") {
+			ok = in.Int(n) && in.AtEnd();
+			(key == "strictAB" ? p.strictAB : p.groupByMaterial) = (n != 0);
+		} else if (key == "maxImproveIter" || key == "improveTimeMs" || key == "threadCount" || key == "exactNodeLimit" ||
+			key == "exactTimeMs" || key == "patternReduceIter" || key == "svcPasses" || key == "timeLimitMs" ||
+			key == "stations") {
+			ok = in.Int(n) && in.AtEnd();
+			if (key == "maxImproveIter") p.maxImproveIter = n;
+			else if (key == "improveTimeMs") p.improveTimeMs = n;
+			else if (key == "threadCount") p.threadCount = n;
+			else if (key == "exactNodeLimit") p.exactNodeLimit = n;
+			else if (key == "exactTimeMs") p.exactTimeMs = n;
+			else if (key == "patternReduceIter") p.patternReduceIter = n;
+			else if (key == "svcPasses") p.svcPasses = n;
+			else if (key == "stations") out.stations.count = n;
+			else out.timeLimitMs = n;
+		} else {
+			ok = in.Number(v) && in.AtEnd();
+			if (key == "slit") p.slit = v;
+			else if (key == "trimLoss") p.trimLoss = v;
+			else if (key == "usefulMin") p.usefulMin = v;
+			else if (key == "wasteMax") p.wasteMax = v;
+			else if (key == "patternWasteWeight") p.patternWasteWeight = v;
+			else if (key == "maxStockLength") p.maxStockLength = v;
+			else if (key == "extraLenMM") out.extraLenMM = v;
+			else if (key == "secondsPerCut") out.stations.secondsPerCut = v;
+			else if (key == "secondsPerSetup") out.stations.secondsPerSetup = v;
+			else return fail(("unknown key " + key).c_str());
+		}
+		if (!ok)
+			return fail(("bad value for " + key).c_str());
+	}
+	if (!headerSeen) {
+		error = "not a cutting job file";
+		return false;
+	}
+	return true;
+}
+
+} // namespace CuttingJob
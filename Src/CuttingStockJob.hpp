@@ -0,0 +1,41 @@
+#ifndef CUTTINGSTOCKJOB_HPP
+#define CUTTINGSTOCKJOB_HPP
+
+#include "CuttingStockSolver.hpp"
+#include "FastProductionExport.hpp"
+#include <string>
+#include <vector>
+
+// Задание раскроя — точные входные данные RunCuttingPlan, чтобы воспроизвести план вне Archicad
+// (Tools/JobRunner). Текстовый формат с версией: первая строка "ArchPlanksJob <версия>",
+// затем строки "ключ значения"; числа — с полной точностью, строки — UTF-8 до конца строки.
+
+namespace CuttingJob {
+
+using CuttingStock::Int32;
+using CuttingStock::UInt32;
+
+/** Версия формата: увеличивать при изменении набора или смысла полей. */
+const UInt32 kFormatVersion = 3;
+
+struct Job {
+	CuttingStock::DemandSet demand;
+	CuttingStock::SolverParams params;                   // stockTypes — заготовки выделения без допуска по длине
+	double extraLenMM = 0.0;                             // допуск по длине заготовки, мм
+	std::vector<CuttingStock::StockType> offcutStock;    // деловые остатки со склада на момент запуска
+	int timeLimitMs = 0;                                 // лимит решения (SolveControl), мс
+	std::vector<FastProduction::SectionRow> sections;    // сечения выделения — для сводок и инструкций
+	FastProduction::StationParams stations;              // пилы для распределения сценариев (ScheduleStations)
+};
+
+/** Параметры, с которыми решается задание: CuttingStock::ApplyExtraLength и деловые остатки после заготовок. */
+CuttingStock::SolverParams SolveParams(const Job& job);
+
+std::string Write(const Job& job);
+
+/** false — не задание, неподдерживаемая версия или ошибка в строке (описание в error). */
+bool Read(const std::string& text, Job& out, std::string& error);
+
+} // namespace CuttingJob
+
+#endif
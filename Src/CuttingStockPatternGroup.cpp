@@ -0,0 +1,155 @@
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+#include <vector>
+
+// Общая часть column generation и SVC для спроса одной ширины: длины деталей, заготовки группы,
+// рюкзак по ценам деталей, запись раскроев в план и жадная доупаковка того, что раскроям не досталось.
+// Вес детали и ёмкость заготовки — length + slit и length - trimLoss + slit: тогда остаток раскроя
+// = ёмкость - Σ веса, что совпадает с остатком в SolveGreedy.
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+const double kEps = 1e-9;
+
+} // anonymous
+
+PatternGroup BuildPatternGroup(const DemandSet& demand, const SolverParams& params)
+{
+	PatternGroup group;
+	group.demand = &demand;
+	group.params = &params;
+	group.stock = ResolveStockTypes(params);
+	group.boardW = demand.items.empty() ? 0.0 : demand.items[0].boardW;
+	group.slit = std::max(ToMM(params.slit), 0);
+	group.maxCapacity = 0;
+	group.residual.materials = demand.materials;
+
+	const Int32 trimLoss = std::max(ToMM(params.trimLoss), 0);
+	Int32 maxLen = 0;
+	for (size_t t = 0; t < group.stock.size(); ++t) {
+		const StockType& st = group.stock[t];
+		if (!StockFitsWidth(st, group.boardW) || st.available == 0) continue;
+		const Int32 cap = ToMM(st.length) - trimLoss + group.slit;
+		if (cap <= group.slit) continue;
+		group.stocks.push_back({ static_cast<Int32>(t), cap, st.cost, st.priority, st.available < 0 ? -1 : st.available });
+		group.maxCapacity = std::max(group.maxCapacity, cap);
+		maxLen = std::max(maxLen, ToMM(st.length));
+	}
+
+	std::vector<size_t> byLen;
+	for (size_t i = 0; i < demand.items.size(); ++i) {
+		const PartDemand& d = demand.items[i];
+		if (d.count <= 0) continue;
+		if (d.lengthMM <= 0 || d.lengthMM + trimLoss > maxLen) {
+			group.residual.items.push_back(d);
+			continue;
+		}
+		byLen.push_back(i);
+	}
+	std::stable_sort(byLen.begin(), byLen.end(),
+		[&demand](size_t a, size_t b) { return demand.items[a].lengthMM > demand.items[b].lengthMM; });
+	for (size_t src : byLen) {
+		const PartDemand& d = demand.items[src];
+		if (group.items.empty() || group.items.back().length != d.lengthMM)
+			group.items.push_back({ d.lengthMM, d.lengthMM + group.slit, 0, {} });
+		group.items.back().demand += d.count;
+		group.items.back().sources.push_back(src);
+	}
+	return group;
+}
+
+void AddResidual(PatternGroup& group, const PatternItem& item, Int32 placed)
+{
+	for (size_t src : item.sources) {
+		PartDemand d = group.demand->items[src];
+		const Int32 skip = std::min(placed, d.count);
+		placed -= skip;
+		d.count -= skip;
+		if (d.count > 0)
+			group.residual.items.push_back(d);
+	}
+}
+
+void AddPatternBoards(PatternGroup& group, const std::vector<PatternItem>& items, const std::vector<Int32>& counts, size_t stock,
+	Int32 copies, PlanResult& result)
+{
+	PatternStock& opt = group.stocks[stock];
+	std::vector<Int32> cuts;
+	Int32 used = 0;
+	for (size_t i = 0; i < items.size(); ++i) {
+		for (Int32 k = 0; k < counts[i]; ++k) cuts.push_back(items[i].length);
+		used += counts[i] * items[i].weight;
+	}
+	ResultBoard rb = {};
+	rb.boardW = group.boardW;
+	rb.stockType = opt.type;
+	rb.stockLength = group.stock[opt.type].length;
+	rb.remainder = static_cast<double>(opt.capacity - used);
+	for (Int32 c = 0; c < copies; ++c) result.AddBoard(rb, cuts);
+	if (opt.left > 0) opt.left -= std::min(opt.left, copies);
+}
+
+void FinishPatternGroup(PatternGroup& group, PlanResult& result)
+{
+	if (group.residual.items.empty()) return;
+	SolverParams rest = *group.params;
+	rest.stockTypes = group.stock;
+	for (const PatternStock& opt : group.stocks)
+		rest.stockTypes[opt.type].available = opt.left;
+	PlanResult tail = SolveGreedy(group.residual, rest);
+	for (size_t b = 0; b < tail.boards.size(); ++b) result.AddBoard(tail.boards[b], tail.Cuts(b));
+	for (size_t r = 0; r < tail.remaining.size(); ++r) result.remaining.push_back(tail.remaining[r]);
+}
+
+void PatternKnapsack::Solve(const std::vector<PatternItem>& items, const std::vector<double>& values, const std::vector<Int32>& bounds,
+	Int32 capacity)
+{
+	split.clear();
+	itemCount = items.size();
+	for (size_t i = 0; i < items.size(); ++i) {
+		Int32 bound = std::min(bounds[i], capacity / items[i].weight);
+		for (Int32 mult = 1; bound > 0; mult *= 2) {
+			const Int32 m = std::min(mult, bound);
+			split.push_back({ i, m, m * items[i].weight, m * values[i] });
+			bound -= m;
+		}
+	}
+
+	rowWords = static_cast<size_t>(capacity) / 64 + 1;
+	best.assign(static_cast<size_t>(capacity) + 1, -1.0);
+	take.assign(split.size() * rowWords, 0);
+	best[0] = 0.0;
+	for (size_t s = 0; s < split.size(); ++s) {
+		const Split& it = split[s];
+		UInt64* row = &take[s * rowWords];
+		for (Int32 w = capacity; w >= it.weight; --w) {
+			const double from = best[w - it.weight];
+			if (from < 0.0) continue;
+			if (from + it.value > best[w] + kEps) {
+				best[w] = from + it.value;
+				row[w / 64] |= (UInt64(1) << (w % 64));
+			}
+		}
+	}
+	bestUpTo.resize(best.size());
+	for (size_t w = 0; w < best.size(); ++w)
+		bestUpTo[w] = w == 0 ? best[0] : std::max(bestUpTo[w - 1], best[w]);
+}
+
+void PatternKnapsack::Counts(Int32 w, std::vector<Int32>& out) const
+{
+	out.assign(itemCount, 0);
+	for (size_t s = split.size(); s-- > 0;) {
+		const UInt64* row = &take[s * rowWords];
+		if (row[w / 64] & (UInt64(1) << (w % 64))) {
+			out[split[s].type] += split[s].mult;
+			w -= split[s].weight;
+		}
+	}
+}
+
+} // namespace Internal
+} // namespace CuttingStock
@@ -0,0 +1,273 @@
+#include "CuttingStockInternal.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+
+// Сокращение числа различных раскроев (в духе KOMBI): каждый лишний раскрой — перестановка упора на пиле.
+// Работает по группам boardW; число досок и типы заготовок не меняются.
+// Ход: две доски одного типа заготовки отдают детали в общий пул, одна из них получает уже существующий
+// раскрой T, вторая — остаток пула (если помещается и остаток допустим).
+// Критерий: раскроев + patternWasteWeight * (досок с отходом 0 < остаток <= B), при равенстве —
+// больше Σ count² (доски стягиваются к частым раскроям), поэтому процесс конечен.
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+using PatternKey = std::pair<Int32, std::vector<Int32>>;   // тип заготовки, длины по убыванию
+
+struct Board {
+	Int32 cap;               // stockLength - trimLoss + slit
+	double stockLength;
+	PatternKey key;
+};
+
+struct Score {
+	double cost;
+	long long concentration;
+};
+
+static bool IsBetter(const Score& a, const Score& b)
+{
+	if (std::fabs(a.cost - b.cost) > 1e-9) return a.cost < b.cost;
+	return a.concentration > b.concentration;
+}
+
+// a ⊆ pool (мультимножества, оба по убыванию); rest = pool \ a
+static bool SubtractSorted(const std::vector<Int32>& pool, const std::vector<Int32>& a, std::vector<Int32>& rest)
+{
+	rest.clear();
+	size_t k = 0;
+	for (Int32 len : pool) {
+		if (k < a.size() && a[k] == len) {
+			++k;
+			continue;
+		}
+		if (k < a.size() && a[k] > len) return false;
+		rest.push_back(len);
+	}
+	return k == a.size();
+}
+
+class PatternReducer {
+public:
+	PatternReducer(std::vector<Board>& boards, const SolverParams& params, int& evalLeft, const SolveContext& ctx) :
+		boards(boards),
+		slit(std::max(ToMM(params.slit), 0)),
+		params(params),
+		wasteMax(ToMM(params.wasteMax)),
+		wasteWeight(params.patternWasteWeight),
+		evalLeft(evalLeft),
+		ctx(ctx)
+	{
+		for (const Board& b : boards) {
+			counts[b.key] += 1;
+			if (IsWaste(b)) ++wasteBoards;
+		}
+	}
+
+	void Run()
+	{
+		while (evalLeft > 0 && !ctx.Stopped() && Step()) {}
+	}
+
+private:
+	std::vector<Board>& boards;
+	const Int32 slit;
+	const SolverParams& params;
+	const Int32 wasteMax;
+	const double wasteWeight;
+	int& evalLeft;
+	const SolveContext& ctx;
+	std::map<PatternKey, Int32> counts;
+	Int32 wasteBoards = 0;
+
+	Int32 Load(const std::vector<Int32>& cuts) const
+	{
+		Int32 load = 0;
+		for (Int32 len : cuts) load += len + slit;
+		return load;
+	}
+
+	bool IsWaste(const Board& b) const
+	{
+		const Int32 rem = b.cap - Load(b.key.second);
+		return rem > 0 && rem <= wasteMax;
+	}
+
+	bool IsValid(const Board& b) const
+	{
+		return ValidRemainder(b.cap - Load(b.key.second), params);
+	}
+
+	Score Evaluate() const
+	{
+		Score s = { static_cast<double>(counts.size()) + wasteWeight * wasteBoards, 0 };
+		for (const auto& c : counts) s.concentration += static_cast<long long>(c.second) * c.second;
+		return s;
+	}
+
+	void Remove(const Board& b)
+	{
+		auto it = counts.find(b.key);
+		if (--it->second == 0) counts.erase(it);
+		if (IsWaste(b)) --wasteBoards;
+	}
+
+	void Add(const Board& b)
+	{
+		counts[b.key] += 1;
+		if (IsWaste(b)) ++wasteBoards;
+	}
+
+	// Доски i и j получают раскрои ki и kj; false — критерий не улучшился (всё возвращается)
+	bool TryAssign(size_t i, size_t j, const PatternKey& ki, const PatternKey& kj, const Score& before)
+	{
+		Board bi = boards[i];
+		Board bj = boards[j];
+		bi.key = ki;
+		bj.key = kj;
+		if (!IsValid(bi) || !IsValid(bj)) return false;
+
+		Remove(boards[i]);
+		Remove(boards[j]);
+		Add(bi);
+		Add(bj);
+		if (IsBetter(Evaluate(), before)) {
+			boards[i] = bi;
+			boards[j] = bj;
+			return true;
+		}
+		Remove(bi);
+		Remove(bj);
+		Add(boards[i]);
+		Add(boards[j]);
+		return false;
+	}
+
+	// Один улучшающий ход; редкие раскрои — первыми
+	bool Step()
+	{
+		// Представитель каждого раскроя (по первой доске)
+		std::map<PatternKey, size_t> firstBoard;
+		for (size_t b = 0; b < boards.size(); ++b) firstBoard.emplace(boards[b].key, b);
+		std::vector<std::pair<Int32, size_t>> rare;
+		for (const auto& f : firstBoard) rare.push_back({ counts[f.first], f.second });
+		std::stable_sort(rare.begin(), rare.end(),
+			[](const std::pair<Int32, size_t>& a, const std::pair<Int32, size_t>& b) { return a.first < b.first; });
+
+		const Score before = Evaluate();
+		std::vector<Int32> pool;
+		std::vector<Int32> rest;
+		for (const auto& r : rare) {
+			const size_t i = r.second;
+			for (const auto& other : firstBoard) {
+				size_t j = other.second;
+				if (j == i) {
+					// Вторая доска того же раскроя
+					j = boards.size();
+					for (size_t b = i + 1; b < boards.size(); ++b) {
+						if (boards[b].key == boards[i].key) { j = b; break; }
+					}
+					if (j == boards.size()) continue;
+				}
+				if (boards[j].key.first != boards[i].key.first || boards[j].cap != boards[i].cap) continue;
+
+				pool.clear();
+				std::merge(boards[i].key.second.begin(), boards[i].key.second.end(),
+					boards[j].key.second.begin(), boards[j].key.second.end(),
+					std::back_inserter(pool), [](Int32 a, Int32 b) { return a > b; });
+
+				for (const auto& target : counts) {
+					if (target.first.first != boards[i].key.first) continue;
+					if (target.first == boards[i].key || target.first == boards[j].key) continue;
+					if (evalLeft-- <= 0 || ((evalLeft & 1023) == 0 && ctx.Stopped())) return false;
+					if (!SubtractSorted(pool, target.first.second, rest) || rest.empty()) continue;
+					const PatternKey restKey(boards[i].key.first, rest);
+					if (TryAssign(i, j, target.first, restKey, before))
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+} // anonymous
+
+void ReducePatterns(PlanResult& result, const SolverParams& params, const SolveContext& ctx)
+{
+	if (params.patternReduceIter <= 0 || result.boards.size() < 2 || ctx.Stopped())
+		return;
+
+	int evalLeft = params.patternReduceIter;
+	const Int32 slit = std::max(ToMM(params.slit), 0);
+	const Int32 trimLoss = std::max(ToMM(params.trimLoss), 0);
+
+	// Группы boardW; позиции досок группы в result.boards сохраняются
+	std::vector<double> widths;
+	std::vector<std::vector<size_t>> positions;
+	std::unordered_map<Int64, size_t> groupOf;   // SizeKey(boardW) -> группа
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		const auto g = groupOf.emplace(SizeKey(result.boards[b].boardW), widths.size());
+		if (g.second) {
+			widths.push_back(result.boards[b].boardW);
+			positions.push_back({});
+		}
+		positions[g.first->second].push_back(b);
+	}
+
+	bool rewritten = false;
+	for (size_t g = 0; g < widths.size() && evalLeft > 0; ++g) {
+		if (positions[g].size() < 2) continue;
+
+		std::vector<Board> boards;
+		for (size_t pos : positions[g]) {
+			const ResultBoard& rb = result.boards[pos];
+			Board b = { ToMM(rb.stockLength) - trimLoss + slit, rb.stockLength, { rb.stockType, {} } };
+			const std::span<const Int32> cuts = result.Cuts(pos);
+			b.key.second.assign(cuts.begin(), cuts.end());
+			std::sort(b.key.second.begin(), b.key.second.end(), [](Int32 x, Int32 y) { return x > y; });
+			boards.push_back(b);
+		}
+
+		PatternReducer(boards, params, evalLeft, ctx).Run();
+
+		// Новые раскрои группы — в конец cuts; прежние диапазоны уберёт сжатие ниже
+		for (size_t i = 0; i < positions[g].size(); ++i) {
+			const Board& b = boards[i];
+			ResultBoard rb;
+			rb.boardW = widths[g];
+			rb.stockType = b.key.first;
+			rb.stockLength = b.stockLength;
+			rb.firstCut = static_cast<UInt32>(result.cuts.size());
+			rb.cutCount = static_cast<UInt32>(b.key.second.size());
+			double used = params.trimLoss;
+			for (size_t k = 0; k < b.key.second.size(); ++k) {
+				if (k > 0) used += params.slit;
+				used += b.key.second[k];
+				result.cuts.push_back(b.key.second[k]);
+			}
+			rb.remainder = b.stockLength - used;
+			result.boards[positions[g][i]] = rb;
+		}
+		rewritten = true;
+	}
+
+	if (rewritten) {
+		BoardTable compact;
+		compact.boards.reserve(result.boards.size());
+		compact.cuts.reserve(result.cuts.size());
+		for (size_t b = 0; b < result.boards.size(); ++b)
+			compact.AddBoard(result.boards[b], result.Cuts(b));
+		static_cast<BoardTable&>(result) = std::move(compact);
+	}
+}
+
+} // namespace Internal
+} // namespace CuttingStock
@@ -0,0 +1,64 @@
+#include "CuttingStockProfiles.hpp"
+#include "CuttingStockInternal.hpp"
+#include <cmath>
+
+namespace CuttingStock {
+
+Int64 SizeKey(double mm)
+{
+	return static_cast<Int64>(std::llround(mm * 1000.0));
+}
+
+size_t ProfileTable::KeyHash::operator()(const Key& k) const
+{
+	UInt64 h = static_cast<UInt64>(k.thickness) * 0x9E3779B97F4A7C15ull;
+	h ^= static_cast<UInt64>(k.width) + 0x7F4A7C159E3779B9ull + (h << 6) + (h >> 2);
+	h ^= static_cast<UInt64>(k.materialId) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	return static_cast<size_t>(h);
+}
+
+UInt32 ProfileTable::Intern(double thicknessMM, double widthMM, const std::string& material)
+{
+	const auto mat = materialIds.emplace(material, static_cast<UInt32>(materials.size()));
+	if (mat.second)
+		materials.push_back(material);
+	const Key key = { SizeKey(thicknessMM), SizeKey(widthMM), mat.first->second };
+	const auto found = profileIds.emplace(key, static_cast<UInt32>(profiles.size()));
+	if (found.second) {
+		profiles.push_back({ thicknessMM, widthMM, mat.first->second });
+		firstOfWidth.emplace(key.width, found.first->second);
+	}
+	return found.first->second;
+}
+
+Int32 ProfileTable::FindWidth(double widthMM) const
+{
+	const auto it = firstOfWidth.find(SizeKey(widthMM));
+	return it == firstOfWidth.end() ? -1 : static_cast<Int32>(it->second);
+}
+
+double ProfileTable::ThicknessForWidth(double widthMM) const
+{
+	const Int32 id = FindWidth(widthMM);
+	return id < 0 ? 0.0 : profiles[static_cast<size_t>(id)].thicknessMM;
+}
+
+void ProfileTable::AddDemand(DemandSet& demand, UInt32 profile, double length, Int32 count)
+{
+	if (count <= 0) return;
+	const SectionProfile& p = profiles[profile];
+	if (demand.materials.size() < materials.size())
+		demand.materials.insert(demand.materials.end(), materials.begin() + static_cast<std::ptrdiff_t>(demand.materials.size()), materials.end());
+
+	// Строки сливаются, как в AddDemand: одинаковые длина в мм, материал и ширина
+	const Int32 lengthMM = Internal::ToMM(length);
+	const Key key = { lengthMM, SizeKey(p.widthMM), p.materialId };
+	const auto row = demandRows.emplace(key, demand.items.size());
+	if (!row.second) {
+		demand.items[row.first->second].count += count;
+		return;
+	}
+	demand.items.push_back({ lengthMM, p.materialId, p.widthMM, count });
+}
+
+} // namespace CuttingStock
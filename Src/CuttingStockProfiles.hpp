@@ -0,0 +1,63 @@
+#ifndef CUTTINGSTOCKPROFILES_HPP
+#define CUTTINGSTOCKPROFILES_HPP
+
+#include "CuttingStockSolver.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Таблица сечений: каждый профиль (толщина, ширина, материал) хранится один раз, дальше — по id.
+// Строится при сборе досок; ширины и толщины сравниваются по целому ключу SizeKey, а не перебором fabs.
+
+namespace CuttingStock {
+
+/** Размер в целых 0.001 мм — ключ для сравнения ширин и толщин (прежний допуск fabs(a - b) < 0.001). */
+Int64 SizeKey(double mm);
+
+struct SectionProfile {
+	double thicknessMM;   // iWidth
+	double widthMM;       // iHeight — boardW досок
+	UInt32 materialId;    // индекс в Materials() (он же DemandSet::materials спроса этой таблицы)
+};
+
+class ProfileTable {
+public:
+	/** id профиля; новый профиль получает следующий id. */
+	UInt32 Intern(double thicknessMM, double widthMM, const std::string& material);
+
+	/** Первый профиль ширины widthMM; -1 — такой ширины нет. */
+	Int32 FindWidth(double widthMM) const;
+
+	/** Толщина первого профиля ширины widthMM; 0 — такой ширины нет. */
+	double ThicknessForWidth(double widthMM) const;
+
+	const SectionProfile& Profile(UInt32 id) const { return profiles[id]; }
+	size_t Size() const { return profiles.size(); }
+	const std::vector<std::string>& Materials() const { return materials; }
+
+	/** Как CuttingStock::AddDemand, но строка спроса находится по индексу. demand должен собираться
+	 *  только этой таблицей: его materials — Materials(). */
+	void AddDemand(DemandSet& demand, UInt32 profile, double length, Int32 count = 1);
+
+private:
+	struct Key {
+		Int64 thickness;
+		Int64 width;
+		UInt32 materialId;
+		bool operator==(const Key& o) const { return thickness == o.thickness && width == o.width && materialId == o.materialId; }
+	};
+	struct KeyHash {
+		size_t operator()(const Key& k) const;
+	};
+
+	std::vector<SectionProfile> profiles;
+	std::vector<std::string> materials;
+	std::unordered_map<std::string, UInt32> materialIds;
+	std::unordered_map<Key, UInt32, KeyHash> profileIds;
+	std::unordered_map<Int64, UInt32> firstOfWidth;
+	std::unordered_map<Key, size_t, KeyHash> demandRows;   // (длина мм, ширина, материал) -> строка спроса
+};
+
+} // namespace CuttingStock
+
+#endif
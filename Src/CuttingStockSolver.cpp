@@ -1,5 +1,17 @@
 #include "CuttingStockSolver.hpp"
+#include "CuttingStockInternal.hpp"
+#include "CuttingStockBucketIndex.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace CuttingStock {
 
@@ -8,23 +20,40 @@ namespace {
 const double W1 = 1e9;   // штраф за новую заготовку
 const double W2 = 1.0;
 const double W3 = 5000.0; // штраф за отход
+const double W4 = 1e6;   // штраф за приоритет типа заготовки
 
-struct PlacedPart {
-	double length;
-	GS::UniString material;
-	double boardW;
-};
+// Группа решается точно, если в ней меньше деталей и различных длин
+const Int32 kExactMaxPieces = 200;
+const Int32 kExactMaxLengths = 30;
 
+// Открытая доска жадного решения; распилы — список в общем пуле CutNode решения
 struct BoardState {
 	double used;
 	double boardW;
-	GS::Array<PlacedPart> placed;
+	double stockLength;
+	Int32 stockType;
+	UInt32 firstCut;
+	UInt32 lastCut;
+	UInt32 cutCount;
+};
+
+// Пул распилов на одно решение: без выделения памяти на доску, освобождается целиком
+struct CutNode {
+	Int32 length;   // мм
+	UInt32 next;    // следующий распил доски; kNoCut — последний
+};
+
+const UInt32 kNoCut = 0xFFFFFFFFu;
+
+// Остаток спроса по различным длинам одной ширины (по убыванию) — для оценки нового типа заготовки
+struct DemandLevel {
+	double length;
+	Int32 left;
 };
 
 static bool IsInvalidRemainder(double remainder, const SolverParams& p) {
 	if (remainder < 0) return true;
-	if (p.strictAB && remainder > p.wasteMax && remainder < p.usefulMin) return true;
-	return false;
+	return !Internal::ValidRemainder(Internal::ToMM(remainder), p);
 }
 
 static double ScoreRemainder(double remainder, bool willOpenNew, const SolverParams& p) {
@@ -36,100 +65,938 @@ static double ScoreRemainder(double remainder, bool willOpenNew, const SolverPar
 	return score;
 }
 
-static SolverResult SolveGreedy(GS::Array<Part> parts, const SolverParams& params) {
-	SolverResult result;
-	if (parts.IsEmpty()) return result;
-
-	// Сортировка по убыванию длины
-	for (UIndex i = 0; i < parts.GetSize(); ++i) {
-		for (UIndex j = i + 1; j < parts.GetSize(); ++j) {
-			if (parts[j].length > parts[i].length) {
-				Part tmp = parts[i];
-				parts[i] = parts[j];
-				parts[j] = tmp;
-			}
-		}
+// Сколько мм деталей ляжет на новую заготовку, если заполнять её First Fit Decreasing из остатка спроса
+static double EstimateFill(double freeLen, double firstLen, const std::vector<DemandLevel>& levels, double slit) {
+	double fill = firstLen;
+	for (const DemandLevel& lv : levels) {
+		if (lv.left <= 0) continue;
+		const double w = lv.length + slit;
+		Int32 k = static_cast<Int32>(std::floor(freeLen / w));
+		if (k <= 0) continue;
+		if (k > lv.left) k = lv.left;
+		freeLen -= k * w;
+		fill += k * lv.length;
 	}
+	return fill;
+}
 
-	GS::Array<BoardState> boards;
-	const double maxL = params.maxStockLength;
+// Типы заготовок для новой доски и замены на более дешёвую. Деловые остатки (тип с материалом) одной ширины,
+// материала и priority, у которых цена растёт с длиной, собраны в семейство по возрастанию длины: из него
+// берётся самый короткий подходящий остаток (бинарный поиск). Остальные типы перебираются по одному
+struct StockCatalog {
+	std::vector<Int32> single;
+	std::vector<std::vector<Int32>> families;
+	std::vector<Int32> candidates;   // рабочие списки ChooseStockForNewBoard
+	std::vector<double> unitCost;
+};
 
-	for (UIndex i = 0; i < parts.GetSize(); ++i) {
-		const Part& p = parts[i];
-		if (p.length + params.trimLoss > maxL) {
-			result.remaining.Push(p);
+static StockCatalog BuildStockCatalog(const std::vector<StockType>& stock) {
+	StockCatalog catalog;
+	std::map<std::tuple<Int64, std::string, Int32>, size_t> familyOf;
+	std::vector<std::vector<Int32>> groups;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		const StockType& st = stock[t];
+		if (st.material.empty() || st.length <= 0.0) {
+			catalog.single.push_back(static_cast<Int32>(t));
 			continue;
 		}
+		const auto key = std::make_tuple(st.boardW > 0.0 ? SizeKey(st.boardW) : Int64(0), st.material, st.priority);
+		const size_t g = familyOf.emplace(key, groups.size()).first->second;
+		if (g == groups.size()) groups.push_back({});
+		groups[g].push_back(static_cast<Int32>(t));
+	}
+	for (std::vector<Int32>& family : groups) {
+		std::stable_sort(family.begin(), family.end(), [&stock](Int32 a, Int32 b) {
+			return stock[a].length != stock[b].length ? stock[a].length < stock[b].length : stock[a].cost < stock[b].cost;
+		});
+		bool rising = family.size() > 1;
+		for (size_t i = 1; rising && i < family.size(); ++i) {
+			if (stock[family[i]].length != stock[family[i - 1]].length && !(stock[family[i]].cost > stock[family[i - 1]].cost))
+				rising = false;
+		}
+		if (rising) catalog.families.push_back(std::move(family));
+		else catalog.single.insert(catalog.single.end(), family.begin(), family.end());
+	}
+	std::sort(catalog.single.begin(), catalog.single.end());
+	return catalog;
+}
 
-		bool placed = false;
-		double bestScore = 1e12;
-		UIndex bestBoardIdx = 0;
-		bool bestIsNew = false;
-
-		for (UIndex b = 0; b < boards.GetSize(); ++b) {
-			BoardState& st = boards[b];
-			if (st.boardW != p.boardW) continue; // пока группируем по boardW
-			double need = st.placed.IsEmpty() ? (params.trimLoss + p.length) : (st.used + params.slit + p.length);
-			if (need > maxL) continue;
-			double rem = maxL - need;
-			double sc = ScoreRemainder(rem, false, params);
-			if (sc < bestScore) {
-				bestScore = sc;
-				bestBoardIdx = b;
-				bestIsNew = false;
-				placed = true;
-			}
+// Самый короткий тип семейства не короче minLength, который есть в наличии и даёт раскрою длины used
+// допустимый остаток; -1 — такого нет
+static Int32 ShortestInFamily(const std::vector<Int32>& family, const std::vector<StockType>& stock, const std::vector<Int32>& stockLeft,
+	double minLength, double used, const SolverParams& params) {
+	auto from = [&](double len) {
+		return std::partition_point(family.begin(), family.end(), [&](Int32 t) { return stock[t].length < len; });
+	};
+	const Int32 usefulMM = Internal::ToMM(params.usefulMin);
+	for (auto it = from(minLength); it != family.end();) {
+		const double rem = stock[*it].length - used;
+		if (!IsInvalidRemainder(rem, params)) {
+			if (stockLeft[*it] != 0) return *it;
+			++it;
+		} else if (Internal::ToMM(rem) > 0) {
+			it = std::max(it + 1, from(used + usefulMM - 0.5));   // остаток между B и A — дальше не короче used + A
+		} else {
+			++it;
 		}
+	}
+	return -1;
+}
 
-		if (!placed || bestScore > W1 * 0.5) {
-			double remNew = maxL - params.trimLoss - p.length;
-			double scNew = ScoreRemainder(remNew, true, params);
-			if (scNew <= bestScore) {
-				bestIsNew = true;
-				placed = true;
+// Выбор типа для новой заготовки: минимальная цена на мм ожидаемой загрузки, затем priority, затем остаток.
+// При одном типе совпадает с прежней оценкой ScoreRemainder(rem, true).
+static Int32 ChooseStockForNewBoard(const PartDemand& p, const std::vector<StockType>& stock, StockCatalog& catalog,
+	const std::vector<Int32>& stockLeft, const std::vector<DemandLevel>& levels, const SolverParams& params, double& outScore) {
+	const double length = p.lengthMM;
+	std::vector<Int32>& candidates = catalog.candidates;
+	candidates.clear();
+	for (Int32 t : catalog.single) {
+		if (stockLeft[t] != 0 && Internal::StockFitsWidth(stock[t], p.boardW) && length + params.trimLoss <= stock[t].length)
+			candidates.push_back(t);
+	}
+	// Из семейства — самые короткие остатки под деталь и под деталь с первыми k деталями FFD-заполнения
+	// самого длинного остатка: остаток длиннее такого порога, но короче следующего, загружен не лучше
+	for (const std::vector<Int32>& family : catalog.families) {
+		if (!Internal::StockFitsWidth(stock[family[0]], p.boardW)) continue;
+		const double used = params.trimLoss + length;
+		double extra = 0.0;
+		double freeLen = stock[family.back()].length - used + params.slit;
+		Int32 t = ShortestInFamily(family, stock, stockLeft, used, used, params);
+		if (t >= 0) candidates.push_back(t);
+		for (size_t l = 0; l < levels.size() && t >= 0; ++l) {
+			const double w = levels[l].length + params.slit;
+			for (Int32 k = 0; k < levels[l].left && freeLen >= w && t >= 0; ++k) {
+				freeLen -= w;
+				extra += w;
+				t = ShortestInFamily(family, stock, stockLeft, used + extra - params.slit, used, params);
+				if (t >= 0 && t != candidates.back()) candidates.push_back(t);
 			}
 		}
+	}
+	if (candidates.empty())
+		return -1;
+	if (!catalog.families.empty()) {
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
 
-		if (!placed) {
-			result.remaining.Push(p);
-			continue;
+	std::vector<double>& unitCost = catalog.unitCost;
+	unitCost.assign(candidates.size(), 0.0);
+	double minUnitCost = 0.0;
+	if (candidates.size() > 1) {
+		for (size_t c = 0; c < candidates.size(); ++c) {
+			const StockType& st = stock[candidates[c]];
+			const double freeLen = st.length - params.trimLoss - length + params.slit;
+			unitCost[c] = st.cost / EstimateFill(freeLen, length, levels, params.slit);
+			if (minUnitCost <= 0.0 || unitCost[c] < minUnitCost)
+				minUnitCost = unitCost[c];
 		}
+	}
 
-		if (bestIsNew) {
-			BoardState st;
-			st.used = params.trimLoss + p.length;
-			st.boardW = p.boardW;
-			st.placed.Push({ p.length, p.material, p.boardW });
-			boards.Push(st);
-		} else {
-			BoardState& st = boards[bestBoardIdx];
-			if (!st.placed.IsEmpty())
+	Int32 best = -1;
+	double bestScore = 0.0;
+	for (size_t c = 0; c < candidates.size(); ++c) {
+		const StockType& st = stock[candidates[c]];
+		const double rem = st.length - params.trimLoss - length;
+		double sc = ScoreRemainder(rem, true, params);
+		if (candidates.size() > 1 && sc < 1e12) {
+			if (minUnitCost > 0.0)
+				sc += W1 * (unitCost[c] / minUnitCost - 1.0);
+			sc += W4 * st.priority;
+		}
+		if (best < 0 || sc < bestScore) {
+			best = candidates[c];
+			bestScore = sc;
+		}
+	}
+	outScore = bestScore;
+	return best;
+}
+
+} // anonymous
+
+namespace Internal {
+
+Int32 ToMM(double value) {
+	return static_cast<Int32>(std::lround(value));
+}
+
+bool ValidRemainder(Int32 remMM, const SolverParams& params) {
+	if (remMM < 0) return false;
+	return !(params.strictAB && remMM > ToMM(params.wasteMax) && remMM < ToMM(params.usefulMin));
+}
+
+std::vector<StockType> ResolveStockTypes(const SolverParams& params) {
+	std::vector<StockType> stock;
+	for (size_t t = 0; t < params.stockTypes.size(); ++t) {
+		StockType st = params.stockTypes[t];
+		if (st.length <= 0.0) st.length = 0.0;   // некорректный тип не участвует, индексы сохраняются
+		if (st.cost <= 0.0) st.cost = 1.0;
+		stock.push_back(st);
+	}
+	if (stock.empty())
+		stock.push_back({ params.maxStockLength, 1.0, -1, 0, 0.0 });
+	return stock;
+}
+
+bool StockFitsWidth(const StockType& stock, double boardW) {
+	return stock.length > 0.0 && (stock.boardW <= 0.0 || SizeKey(stock.boardW) == SizeKey(boardW));
+}
+
+PlanResult SolveGreedy(const DemandSet& demand, const SolverParams& params) {
+	PlanResult result;
+	const std::vector<PartDemand>& items = demand.items;
+	if (items.empty()) return result;
+
+	// Порядок строк спроса: по убыванию длины (стабильно)
+	std::vector<size_t> order;
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (items[i].count > 0) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&items](size_t a, size_t b) { return items[a].lengthMM > items[b].lengthMM; });
+
+	const std::vector<StockType> stock = ResolveStockTypes(params);
+	StockCatalog catalog = BuildStockCatalog(stock);
+	std::vector<Int32> stockLeft(stock.size());
+	Int32 maxStockMM = 0;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		stockLeft[t] = stock[t].available < 0 ? -1 : stock[t].available;
+		maxStockMM = std::max(maxStockMM, ToMM(stock[t].length));
+	}
+
+	// Уровни спроса по ширинам; itemLevel — куда относится каждая строка
+	std::unordered_map<Int64, size_t> levelOf;   // SizeKey(boardW) -> уровни
+	std::vector<std::vector<DemandLevel>> levels;
+	std::vector<std::pair<size_t, size_t>> itemLevel(order.size());
+	for (size_t oi = 0; oi < order.size(); ++oi) {
+		const PartDemand& d = items[order[oi]];
+		const size_t w = levelOf.emplace(SizeKey(d.boardW), levels.size()).first->second;
+		if (w == levels.size())
+			levels.push_back({});
+		if (levels[w].empty() || levels[w].back().length != d.lengthMM)
+			levels[w].push_back({ static_cast<double>(d.lengthMM), 0 });
+		levels[w].back().left += d.count;
+		itemLevel[oi] = { w, levels[w].size() - 1 };
+	}
+
+	// Открытые заготовки каждой ширины — в индексе по свободной длине (целые мм).
+	// Best Fit по ScoreRemainder сводится к двум запросам: наименьшая свободная длина
+	// с остатком <= B (штраф W3) и наименьшая с остатком > B (при strictAB — >= A).
+	const Int32 slitMM = ToMM(params.slit);
+	const Int32 trimMM = ToMM(params.trimLoss);
+	const Int32 wasteMM = ToMM(params.wasteMax);
+	const Int32 loUseful = params.strictAB ? std::max(ToMM(params.usefulMin), wasteMM + 1) : wasteMM + 1;
+	std::vector<BucketIndex> index;
+	std::vector<Int32> retireBelow(levels.size());
+	for (size_t w = 0; w < levels.size(); ++w) {
+		index.emplace_back(maxStockMM);
+		retireBelow[w] = ToMM(levels[w].back().length) + slitMM;
+	}
+
+	std::vector<BoardState> boards;
+	std::vector<CutNode> cutPool;
+	size_t pieceCount = 0;
+	for (size_t oi = 0; oi < order.size(); ++oi) pieceCount += static_cast<size_t>(items[order[oi]].count);
+	cutPool.reserve(pieceCount);
+
+	for (size_t oi = 0; oi < order.size(); ++oi) {
+		const PartDemand& d = items[order[oi]];
+		const size_t w = itemLevel[oi].first;
+		std::vector<DemandLevel>& groupLevels = levels[w];
+		BucketIndex& idx = index[w];
+		const double length = d.lengthMM;
+		const Int32 need = slitMM + d.lengthMM;
+		Int32 unplaced = 0;
+
+		for (Int32 piece = 0; piece < d.count; ++piece) {
+			groupLevels[itemLevel[oi].second].left -= 1;
+
+			Int32 fA = idx.FindFirst(need);
+			if (fA >= 0 && fA - need > wasteMM) fA = -1;
+			const Int32 fB = idx.FindFirst(need + loUseful);
+
+			Int32 chosenFree = -1;
+			if (fA >= 0 && fB >= 0) {
+				const double scoreA = W2 * (fA - need) + W3;
+				const double scoreB = W2 * (fB - need);
+				if (scoreA < scoreB) chosenFree = fA;
+				else if (scoreB < scoreA) chosenFree = fB;
+				else chosenFree = (idx.Front(fA) < idx.Front(fB)) ? fA : fB;
+			} else {
+				chosenFree = (fA >= 0) ? fA : fB;
+			}
+
+			if (chosenFree >= 0) {
+				const UInt32 b = idx.PopFront(chosenFree);
+				BoardState& st = boards[b];
 				st.used += params.slit;
-			st.used += p.length;
-			st.placed.Push({ p.length, p.material, p.boardW });
+				st.used += length;
+				cutPool[st.lastCut].next = static_cast<UInt32>(cutPool.size());
+				st.lastCut = static_cast<UInt32>(cutPool.size());
+				st.cutCount += 1;
+				cutPool.push_back({ d.lengthMM, kNoCut });
+				const Int32 freeLen = chosenFree - need;
+				if (freeLen >= retireBelow[w])
+					idx.Insert(freeLen, b);
+				continue;
+			}
+
+			double scNew = 0.0;
+			const Int32 newStock = ChooseStockForNewBoard(d, stock, catalog, stockLeft, groupLevels, params, scNew);
+			if (newStock < 0 || scNew > 1e12) {
+				++unplaced;
+				continue;
+			}
+			BoardState st;
+			st.used = params.trimLoss + length;
+			st.boardW = d.boardW;
+			st.stockType = newStock;
+			st.stockLength = stock[newStock].length;
+			st.firstCut = st.lastCut = static_cast<UInt32>(cutPool.size());
+			st.cutCount = 1;
+			cutPool.push_back({ d.lengthMM, kNoCut });
+			boards.push_back(st);
+			if (stockLeft[newStock] > 0)
+				stockLeft[newStock] -= 1;
+			const Int32 freeLen = ToMM(st.stockLength) - trimMM - d.lengthMM;
+			if (freeLen >= 0 && freeLen >= retireBelow[w] && freeLen <= idx.MaxFree())
+				idx.Insert(freeLen, static_cast<UInt32>(boards.size() - 1));
+		}
+
+		if (unplaced > 0) {
+			PartDemand rest = d;
+			rest.count = unplaced;
+			result.remaining.push_back(rest);
+		}
+
+		// Кончилась самая короткая длина — заготовки, куда не влезет и следующая, выводим из индекса
+		while (groupLevels.size() > 1 && groupLevels.back().left == 0) {
+			groupLevels.pop_back();
+			retireBelow[w] = ToMM(groupLevels.back().length) + slitMM;
+			idx.RetireBelow(retireBelow[w]);
+		}
+	}
+
+	// Заготовку, открытую «на вырост», меняем на более дешёвый тип, если раскрой в него помещается
+	if (stock.size() > 1) {
+		std::vector<Int32>& candidates = catalog.candidates;
+		for (size_t bi = 0; bi < boards.size(); ++bi) {
+			BoardState& st = boards[bi];
+			candidates.clear();
+			for (Int32 t : catalog.single) {
+				if (stockLeft[t] == 0 || !StockFitsWidth(stock[t], st.boardW)) continue;
+				if (!IsInvalidRemainder(stock[t].length - st.used, params)) candidates.push_back(t);
+			}
+			// В семействе цена растёт с длиной: дешевле всех — самый короткий подходящий
+			for (const std::vector<Int32>& family : catalog.families) {
+				if (!StockFitsWidth(stock[family[0]], st.boardW)) continue;
+				const Int32 t = ShortestInFamily(family, stock, stockLeft, st.used - 0.5, st.used, params);
+				if (t >= 0) candidates.push_back(t);
+			}
+			if (!catalog.families.empty())
+				std::sort(candidates.begin(), candidates.end());
+			Int32 best = st.stockType;
+			for (Int32 t : candidates) {
+				const StockType& cur = stock[best];
+				if (stock[t].cost < cur.cost || (stock[t].cost == cur.cost && stock[t].priority < cur.priority))
+					best = t;
+			}
+			if (best == st.stockType) continue;
+			if (stockLeft[st.stockType] >= 0) stockLeft[st.stockType] += 1;
+			if (stockLeft[best] > 0) stockLeft[best] -= 1;
+			st.stockType = best;
+			st.stockLength = stock[best].length;
 		}
 	}
 
-	for (UIndex bi = 0; bi < boards.GetSize(); ++bi) {
+	result.boards.reserve(boards.size());
+	result.cuts.reserve(cutPool.size());
+	for (size_t bi = 0; bi < boards.size(); ++bi) {
 		const BoardState& st = boards[bi];
 		ResultBoard rb;
 		rb.boardW = st.boardW;
-		rb.remainder = maxL - st.used;
-		for (UIndex pi = 0; pi < st.placed.GetSize(); ++pi)
-			rb.cuts.Push(st.placed[pi].length);
-		result.boards.Push(rb);
+		rb.stockType = st.stockType;
+		rb.stockLength = st.stockLength;
+		rb.remainder = st.stockLength - st.used;
+		rb.firstCut = static_cast<UInt32>(result.cuts.size());
+		rb.cutCount = st.cutCount;
+		for (UInt32 c = st.firstCut; c != kNoCut; c = cutPool[c].next)
+			result.cuts.push_back(cutPool[c].length);
+		result.boards.push_back(rb);
+	}
+
+	return result;
+}
+
+void ParallelFor(size_t count, Int32 threadCount, const std::function<void(size_t)>& fn) {
+	if (count == 0) return;
+	size_t threads = threadCount > 0 ? static_cast<size_t>(threadCount) : std::thread::hardware_concurrency();
+	threads = std::max<size_t>(1, std::min(threads, count));
+	if (threads == 1) {
+		for (size_t i = 0; i < count; ++i) fn(i);
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	auto worker = [&]() {
+		for (;;) {
+			const size_t i = next.fetch_add(1);
+			if (i >= count) return;
+			try {
+				fn(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error) error = std::current_exception();
+				next.store(count);
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+	worker();
+	for (std::thread& th : pool) th.join();
+	if (error) std::rethrow_exception(error);
+}
+
+} // namespace Internal
+
+namespace {
+
+// Независимая группа спроса: одна ширина (и материал при groupByMaterial)
+struct Partition {
+	double boardW;
+	Int64 widthKey;       // SizeKey(boardW)
+	UInt32 materialId;
+	DemandSet demand;
+};
+
+static std::vector<Partition> PartitionDemand(const DemandSet& demand, bool byMaterial) {
+	std::vector<Partition> partitions;
+	std::map<std::pair<Int64, UInt32>, size_t> partitionOf;   // (ширина, материал) -> группа
+	for (size_t i = 0; i < demand.items.size(); ++i) {
+		const PartDemand& d = demand.items[i];
+		if (d.count <= 0) continue;
+		const Int64 widthKey = SizeKey(d.boardW);
+		const UInt32 materialId = byMaterial ? d.materialId : 0;
+		const size_t k = partitionOf.emplace(std::make_pair(widthKey, materialId), partitions.size()).first->second;
+		if (k == partitions.size()) {
+			Partition np;
+			np.boardW = d.boardW;
+			np.widthKey = widthKey;
+			np.materialId = materialId;
+			np.demand.materials = demand.materials;
+			partitions.push_back(np);
+		}
+		partitions[k].demand.items.push_back(d);
+	}
+	// Порядок вывода: по ширине, внутри ширины — по первому появлению материала
+	std::stable_sort(partitions.begin(), partitions.end(),
+		[](const Partition& a, const Partition& b) { return a.widthKey < b.widthKey; });
+	return partitions;
+}
+
+// Заготовка с материалом (деловой остаток) подходит только группе этого материала
+static bool StockFitsPartition(const StockType& stock, const Partition& partition, bool byMaterial) {
+	if (!Internal::StockFitsWidth(stock, partition.boardW)) return false;
+	if (stock.material.empty()) return true;
+	return byMaterial && partition.materialId < partition.demand.materials.size() &&
+		partition.demand.materials[partition.materialId] == stock.material;
+}
+
+// Подходящие каждой группе типы заготовок (по возрастанию индекса) без учёта длины: она у наборов пакета
+// может отличаться и проверяется StockFitsPartition на каждом наборе. Типы одной ширины ищутся по SizeKey,
+// а не сравнением со всеми группами — деловых остатков бывают десятки тысяч
+static std::vector<std::vector<size_t>> FittingStock(const std::vector<Partition>& partitions, const std::vector<StockType>& stock, bool byMaterial) {
+	std::unordered_map<Int64, std::vector<size_t>> ofWidth;   // SizeKey(boardW) -> группы
+	std::vector<size_t> all;
+	for (size_t k = 0; k < partitions.size(); ++k) {
+		ofWidth[partitions[k].widthKey].push_back(k);
+		all.push_back(k);
+	}
+	std::vector<std::vector<size_t>> fitting(partitions.size());
+	for (size_t t = 0; t < stock.size(); ++t) {
+		StockType st = stock[t];
+		st.length = 1.0;
+		const std::vector<size_t>* candidates = &all;
+		if (st.boardW > 0.0) {
+			const auto found = ofWidth.find(SizeKey(st.boardW));
+			if (found == ofWidth.end()) continue;
+			candidates = &found->second;
+		}
+		for (size_t k : *candidates) {
+			if (StockFitsPartition(st, partitions[k], byMaterial)) fitting[k].push_back(t);
+		}
+	}
+	return fitting;
+}
+
+// Группы, делящие тип заготовки с ограниченным количеством, решаются последовательно в одной задаче
+static std::vector<std::vector<size_t>> BuildJobs(const std::vector<Partition>& partitions, const std::vector<std::vector<size_t>>& fitting,
+	const std::vector<StockType>& stock) {
+	std::vector<size_t> parent(partitions.size());
+	for (size_t i = 0; i < parent.size(); ++i) parent[i] = i;
+	auto find = [&parent](size_t x) {
+		while (parent[x] != x) x = parent[x] = parent[parent[x]];
+		return x;
+	};
+	std::vector<size_t> firstOf(stock.size(), partitions.size());   // первая группа, которой подходит тип
+	for (size_t k = 0; k < partitions.size(); ++k) {
+		for (size_t t : fitting[k]) {
+			if (stock[t].available < 0) continue;
+			if (firstOf[t] == partitions.size()) firstOf[t] = k;
+			else parent[find(k)] = find(firstOf[t]);
+		}
+	}
+
+	std::vector<std::vector<size_t>> jobs;
+	std::vector<size_t> jobOfRoot(partitions.size(), partitions.size());
+	for (size_t k = 0; k < partitions.size(); ++k) {
+		const size_t r = find(k);
+		if (jobOfRoot[r] == partitions.size()) {
+			jobOfRoot[r] = jobs.size();
+			jobs.push_back({});
+		}
+		jobs[jobOfRoot[r]].push_back(k);
+	}
+	return jobs;
+}
+
+static Internal::LowerBounds PartitionBounds(const Partition& partition, const SolverParams& params) {
+	const Int32 slit = std::max(Internal::ToMM(params.slit), 0);
+	std::vector<Internal::BoundItem> items;
+	for (size_t i = 0; i < partition.demand.items.size(); ++i) {
+		const PartDemand& d = partition.demand.items[i];
+		items.push_back({ d.lengthMM + slit, d.count });
+	}
+	return Internal::ComputeLowerBounds(items, Internal::MaxCapacityForWidth(Internal::ResolveStockTypes(params), partition.boardW, params));
+}
+
+// Малая группа: точный B&B от эвристического плана; при исчерпании бюджета остаётся эвристика
+static void TryExactPartition(const Partition& partition, const SolverParams& params, const Internal::SolveContext& ctx, Internal::PlanResult& result) {
+	if (params.exactNodeLimit <= 0 || !result.remaining.empty() || result.boards.empty() || ctx.Stopped()) return;
+
+	const std::vector<StockType> stock = Internal::ResolveStockTypes(params);
+	if (!Internal::BoardCountIsObjective(stock, partition.boardW)) return;
+
+	Int32 pieces = 0;
+	std::vector<Int32> lengths;
+	for (size_t i = 0; i < partition.demand.items.size(); ++i) {
+		const PartDemand& d = partition.demand.items[i];
+		pieces += d.count;
+		if (std::find(lengths.begin(), lengths.end(), d.lengthMM) == lengths.end())
+			lengths.push_back(d.lengthMM);
+	}
+	if (pieces >= kExactMaxPieces || static_cast<Int32>(lengths.size()) >= kExactMaxLengths) return;
+
+	// Самая длинная заготовка для ширины; её должно хватить на текущее число досок
+	Int32 type = -1;
+	for (size_t t = 0; t < stock.size(); ++t) {
+		if (!Internal::StockFitsWidth(stock[t], partition.boardW) || stock[t].available == 0) continue;
+		if (type < 0 || stock[t].length > stock[type].length ||
+			(stock[t].length == stock[type].length && stock[t].priority < stock[type].priority))
+			type = static_cast<Int32>(t);
+	}
+	const Int32 boards = static_cast<Int32>(result.boards.size());
+	if (type < 0 || (stock[type].available >= 0 && stock[type].available < boards)) return;
+
+	const Internal::LowerBounds lb = PartitionBounds(partition, params);
+	if (boards <= lb.l2) {
+		result.provenOptimal = true;
+		return;
+	}
+	Internal::PlanResult exact;
+	bool proven = false;
+	if (Internal::SolveExact(partition.demand, params, partition.boardW, type, boards, lb.l2, ctx, exact, proven))
+		result = exact;
+	result.provenOptimal = proven;
+}
+
+// Меньше неразмещённых деталей, затем меньше суммарная цена заготовок
+static bool IsBetterPlan(const Internal::PlanResult& a, const Internal::PlanResult& b, const SolverParams& params) {
+	auto unplaced = [](const Internal::PlanResult& r) {
+		Int64 n = 0;
+		for (size_t i = 0; i < r.remaining.size(); ++i) n += r.remaining[i].count;
+		return n;
+	};
+	const std::vector<StockType> stock = Internal::ResolveStockTypes(params);
+	auto cost = [&stock](const Internal::PlanResult& r) {
+		double c = 0.0;
+		for (size_t i = 0; i < r.boards.size(); ++i) c += stock[r.boards[i].stockType].cost;
+		return c;
+	};
+	if (unplaced(a) != unplaced(b)) return unplaced(a) < unplaced(b);
+	return cost(a) < cost(b) - 1e-9;
+}
+
+// Ход решения групп для SolveControl::onProgress: вызовы по одному, доски — сумма текущих планов групп
+class ProgressReporter {
+public:
+	ProgressReporter(const SolveControl& control, size_t groupCount) :
+		control(control),
+		groupBoards(groupCount, -1)
+	{
+	}
+
+	void Report(size_t group, SolvePhase phase, const Internal::PlanResult& plan, bool groupDone)
+	{
+		if (!control.onProgress) return;
+		std::lock_guard<std::mutex> lock(mutex);
+		groupBoards[group] = static_cast<Int32>(plan.boards.size());
+		if (groupDone) ++groupsDone;
+		Notify(phase);
 	}
 
+	void Finish(Int32 boards)
+	{
+		if (!control.onProgress) return;
+		std::lock_guard<std::mutex> lock(mutex);
+		control.onProgress({ SolvePhase::Done, groupsDone, static_cast<Int32>(groupBoards.size()), boards });
+	}
+
+private:
+	const SolveControl& control;
+	std::mutex mutex;
+	std::vector<Int32> groupBoards;   // -1 — плана группы ещё нет
+	Int32 groupsDone = 0;
+
+	void Notify(SolvePhase phase)
+	{
+		Int32 boards = 0;
+		for (Int32 b : groupBoards) boards += std::max(b, 0);
+		control.onProgress({ phase, groupsDone, static_cast<Int32>(groupBoards.size()), boards });
+	}
+};
+
+static Internal::PlanResult SolvePartition(const Partition& partition, const SolverParams& params, const Internal::SolveContext& ctx,
+	ProgressReporter& progress, size_t group) {
+	Internal::PlanResult result = Internal::SolveGreedy(partition.demand, params);
+	progress.Report(group, SolvePhase::Greedy, result, false);
+	// Жадный план улучшается так же, как в режиме Greedy: CG и SVC заменяют его только своим улучшенным планом,
+	// если тот лучше, — режим не бывает хуже жадного
+	Internal::ImprovePlan(result, params, ctx);
+	const bool alternative = params.mode == SolverMode::ColumnGeneration || params.mode == SolverMode::SequentialValueCorrection;
+	if (alternative && !ctx.Stopped()) {
+		// Улучшенный жадный план уже на нижней оценке — другой алгоритм ничего не даст
+		const Internal::LowerBounds lb = PartitionBounds(partition, params);
+		const bool optimal = result.remaining.empty() && static_cast<Int32>(result.boards.size()) <= lb.l2 &&
+			Internal::BoardCountIsObjective(Internal::ResolveStockTypes(params), partition.boardW);
+		if (!optimal) {
+			const bool cg = params.mode == SolverMode::ColumnGeneration;
+			const auto started = std::chrono::steady_clock::now();
+			Internal::PlanResult other = cg ? Internal::SolveColumnGeneration(partition.demand, params, ctx)
+				: Internal::SolveValueCorrection(partition.demand, params, ctx);
+			// Своё время (не больше improveTimeMs) CG/SVC не отнимают у улучшения остальных групп
+			ctx.improvePausedNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count(),
+				std::memory_order_relaxed);
+			Internal::ImprovePlan(other, params, ctx);
+			if (IsBetterPlan(other, result, params))
+				result = std::move(other);
+			progress.Report(group, cg ? SolvePhase::ColumnGeneration : SolvePhase::ValueCorrection, result, false);
+		}
+	}
+	progress.Report(group, SolvePhase::Improve, result, false);
+	TryExactPartition(partition, params, ctx, result);
+	progress.Report(group, SolvePhase::Exact, result, false);
+	Internal::ReducePatterns(result, params, ctx);
+	progress.Report(group, SolvePhase::ReducePatterns, result, true);
 	return result;
 }
 
+// Ключ слияния досок в шаблон; cuts — диапазон PlanResult::cuts
+struct PatternKey {
+	double boardW;
+	Int32 stockType;
+	double stockLength;
+	Int32 materialId;
+	std::span<const Int32> cuts;
+};
+
+struct PatternKeyLess {
+	bool operator()(const PatternKey& a, const PatternKey& b) const {
+		if (a.boardW != b.boardW) return a.boardW < b.boardW;
+		if (a.stockType != b.stockType) return a.stockType < b.stockType;
+		if (a.stockLength != b.stockLength) return a.stockLength < b.stockLength;
+		if (a.materialId != b.materialId) return a.materialId < b.materialId;
+		return std::lexicographical_compare(a.cuts.begin(), a.cuts.end(), b.cuts.begin(), b.cuts.end());
+	}
+};
+
+// Контекст одного набора параметров пакета: улучшение отсчитывается от начала его первой задачи,
+// чтобы точки, до которых очередь дошла позже, не остались без времени на улучшение
+struct BatchPoint {
+	Internal::SolveContext ctx;
+	std::once_flag started;
+	std::vector<StockType> stock;
+	SolverParams params;   // набор без stockTypes: заготовки каждой группе даёт SolveDemandBatch
+	std::vector<Internal::PlanResult> partial;
+};
+
 } // anonymous
 
-SolverResult Solve(const GS::Array<Part>& parts, const SolverParams& params) {
-	if (parts.IsEmpty()) return SolverResult();
+namespace Internal {
+
+std::vector<PlanResult> SolveDemandBatch(const DemandSet& demand, const std::vector<SolverParams>& paramsList, const SolveControl& control,
+	std::vector<bool>& interrupted) {
+	std::vector<PlanResult> results(paramsList.size());
+	interrupted.assign(paramsList.size(), false);
+	if (paramsList.empty()) return results;
+
+	// Группы и связи по ограниченным заготовкам зависят только от groupByMaterial и доступности/ширин/материалов
+	// заготовок — у всех наборов пакета они одинаковые, поэтому строятся один раз
+	const SolverParams& first = paramsList[0];
+	const std::vector<Partition> partitions = PartitionDemand(demand, first.groupByMaterial);
+	const std::vector<StockType> firstStock = ResolveStockTypes(first);
+	const std::vector<std::vector<size_t>> fitting = FittingStock(partitions, firstStock, first.groupByMaterial);
+	const std::vector<std::vector<size_t>> jobs = BuildJobs(partitions, fitting, firstStock);
+	ProgressReporter progress(control, partitions.size() * paramsList.size());
+
+	std::vector<BatchPoint> points(paramsList.size());
+	for (size_t p = 0; p < points.size(); ++p) {
+		points[p].ctx.cancel = control.cancel;
+		if (control.timeLimitMs > 0) {
+			points[p].ctx.hasDeadline = true;
+			points[p].ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(control.timeLimitMs);
+		}
+		points[p].stock = ResolveStockTypes(paramsList[p]);
+		points[p].params = paramsList[p];
+		points[p].params.stockTypes.clear();
+		points[p].partial.resize(partitions.size());
+	}
+
+	// Наборы — по очереди, внутри набора крупные задачи первыми (LPT): задачи набора идут рядом, как при
+	// одиночном решении, и делят его improveTimeMs; порядок вывода от этого не зависит
+	std::vector<size_t> jobSize(jobs.size(), 0);
+	for (size_t j = 0; j < jobs.size(); ++j) {
+		for (size_t k : jobs[j]) {
+			const std::vector<PartDemand>& items = partitions[k].demand.items;
+			for (size_t i = 0; i < items.size(); ++i) jobSize[j] += static_cast<size_t>(items[i].count);
+		}
+	}
+	std::vector<std::pair<size_t, size_t>> taskOrder;   // (набор параметров, задача)
+	for (size_t p = 0; p < points.size(); ++p) {
+		for (size_t j = 0; j < jobs.size(); ++j) taskOrder.push_back({ p, j });
+	}
+	std::stable_sort(taskOrder.begin(), taskOrder.end(), [&jobSize](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+		if (a.first != b.first) return a.first < b.first;
+		return jobSize[a.second] > jobSize[b.second];
+	});
 
-	GS::Array<Part> sorted = parts;
-	return SolveGreedy(sorted, params);
+	ParallelFor(taskOrder.size(), first.threadCount, [&](size_t t) {
+		const size_t p = taskOrder[t].first;
+		const SolverParams& params = paramsList[p];
+		BatchPoint& point = points[p];
+		std::call_once(point.started, [&]() {
+			if (params.improveTimeMs > 0) {
+				point.ctx.hasImproveDeadline = true;
+				point.ctx.improveDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(params.improveTimeMs);
+			}
+		});
+		// Группа видит только свои типы заготовок; индексы её плана переводятся обратно в индексы набора
+		std::unordered_map<size_t, Int32> taken;   // тип набора -> досок в уже решённых группах задачи
+		for (size_t k : jobs[taskOrder[t].second]) {
+			SolverParams partParams = point.params;
+			std::vector<size_t> typeOf;
+			for (size_t s : fitting[k]) {
+				if (!StockFitsPartition(point.stock[s], partitions[k], params.groupByMaterial)) continue;
+				StockType st = point.stock[s];
+				const auto used = taken.find(s);
+				if (st.available > 0 && used != taken.end()) st.available = std::max(st.available - used->second, 0);
+				partParams.stockTypes.push_back(st);
+				typeOf.push_back(s);
+			}
+			if (typeOf.empty()) {
+				// Пустой список заменился бы на maxStockLength — оставляем тип без остатка
+				partParams.stockTypes.push_back(point.stock[0]);
+				partParams.stockTypes.back().available = 0;
+				typeOf.push_back(0);
+			}
+			PlanResult& r = point.partial[k];
+			r = SolvePartition(partitions[k], partParams, point.ctx, progress, p * partitions.size() + k);
+			for (size_t b = 0; b < r.boards.size(); ++b) {
+				ResultBoard& rb = r.boards[b];
+				rb.materialId = params.groupByMaterial ? static_cast<Int32>(partitions[k].materialId) : -1;
+				rb.stockType = static_cast<Int32>(typeOf[rb.stockType]);
+				if (point.stock[rb.stockType].available > 0) taken[rb.stockType] += 1;
+			}
+		}
+	});
+
+	Int32 boards = 0;
+	for (size_t p = 0; p < points.size(); ++p) {
+		const SolverParams& params = paramsList[p];
+		PlanResult& result = results[p];
+		for (size_t k = 0; k < partitions.size(); ++k) {
+			const PlanResult& r = points[p].partial[k];
+			for (size_t b = 0; b < r.boards.size(); ++b) result.AddBoard(r.boards[b], r.Cuts(b));
+			for (size_t i = 0; i < r.remaining.size(); ++i) result.remaining.push_back(r.remaining[i]);
+
+			const LowerBounds lb = PartitionBounds(partitions[k], params);
+			GroupBound gb;
+			gb.boardW = partitions[k].boardW;
+			if (params.groupByMaterial && partitions[k].materialId < demand.materials.size())
+				gb.material = demand.materials[partitions[k].materialId];
+			gb.l1 = lb.l1;
+			gb.l2 = lb.l2;
+			gb.boards = static_cast<Int32>(r.boards.size());
+			gb.gap = lb.l2 > 0 ? static_cast<double>(gb.boards - lb.l2) / lb.l2 : 0.0;
+			gb.optimal = r.remaining.empty() && (gb.boards <= lb.l2 || r.provenOptimal);
+			result.bounds.push_back(gb);
+		}
+		interrupted[p] = points[p].ctx.stopped.load();
+		boards += static_cast<Int32>(result.boards.size());
+	}
+	progress.Finish(boards);
+	return results;
+}
+
+PatternResult ToPatternResult(const PlanResult& plan, bool interrupted) {
+	PatternResult result;
+	result.interrupted = interrupted;
+
+	// Одинаковые доски сливаем в шаблон (порядок — по первому появлению); ключ ссылается на plan.cuts без копий
+	std::map<PatternKey, size_t, PatternKeyLess> patternOf;
+	for (size_t b = 0; b < plan.boards.size(); ++b) {
+		const ResultBoard& rb = plan.boards[b];
+		const std::span<const Int32> cuts = plan.Cuts(b);
+		const auto found = patternOf.emplace(PatternKey{ rb.boardW, rb.stockType, rb.stockLength, rb.materialId, cuts }, result.patterns.size());
+		if (!found.second) {
+			result.patterns[found.first->second].count += 1;
+			continue;
+		}
+		CutPattern cp;
+		cp.cutsMM.assign(cuts.begin(), cuts.end());
+		cp.remainder = rb.remainder;
+		cp.boardW = rb.boardW;
+		cp.stockType = rb.stockType;
+		cp.stockLength = rb.stockLength;
+		cp.materialId = rb.materialId;
+		cp.count = 1;
+		result.patterns.push_back(cp);
+	}
+	result.remaining = plan.remaining;
+	result.bounds = plan.bounds;
+	return result;
+}
+
+} // namespace Internal
+
+namespace {
+
+// Все группы спроса; доски — в порядке групп, неразмещённое — строками спроса
+static Internal::PlanResult SolveDemand(const DemandSet& demand, const SolverParams& params, const SolveControl& control, bool& interrupted) {
+	std::vector<bool> batchInterrupted;
+	std::vector<Internal::PlanResult> results = Internal::SolveDemandBatch(demand, { params }, control, batchInterrupted);
+	interrupted = batchInterrupted[0];
+	return std::move(results[0]);
+}
+
+} // anonymous
+
+void AddDemand(DemandSet& demand, double length, const std::string& material, double boardW, Int32 count) {
+	if (count <= 0) return;
+	size_t materialId = 0;
+	while (materialId < demand.materials.size() && demand.materials[materialId] != material) ++materialId;
+	if (materialId == demand.materials.size())
+		demand.materials.push_back(material);
+
+	const Int32 lengthMM = Internal::ToMM(length);
+	for (size_t i = 0; i < demand.items.size(); ++i) {
+		PartDemand& d = demand.items[i];
+		if (d.lengthMM == lengthMM && d.materialId == materialId && d.boardW == boardW) {
+			d.count += count;
+			return;
+		}
+	}
+	demand.items.push_back({ lengthMM, static_cast<UInt32>(materialId), boardW, count });
+}
+
+SolverResult Solve(const std::vector<Part>& parts, const SolverParams& params) {
+	return Solve(parts, params, SolveControl());
+}
+
+SolverResult Solve(const std::vector<Part>& parts, const SolverParams& params, const SolveControl& control) {
+	if (parts.empty()) return SolverResult();
+
+	// Материал и ширина — через таблицу профилей: без поиска по всем строкам на каждую деталь
+	DemandSet demand;
+	ProfileTable profiles;
+	for (size_t i = 0; i < parts.size(); ++i)
+		profiles.AddDemand(demand, profiles.Intern(0.0, parts[i].boardW, parts[i].material), parts[i].length);
+
+	SolverResult result;
+	Internal::PlanResult plan = SolveDemand(demand, params, control, result.interrupted);
+	result.boards = std::move(plan.boards);
+	result.cuts = std::move(plan.cuts);
+	result.bounds = plan.bounds;
+	for (size_t b = 0; b < result.boards.size(); ++b)
+		result.boards[b].materialId = -1;   // внутренняя таблица материалов наружу не отдаётся
+	for (size_t i = 0; i < plan.remaining.size(); ++i) {
+		const PartDemand& d = plan.remaining[i];
+		for (Int32 k = 0; k < d.count; ++k)
+			result.remaining.push_back({ static_cast<double>(d.lengthMM), demand.materials[d.materialId], d.boardW });
+	}
+	return result;
+}
+
+PatternResult Solve(const DemandSet& demand, const SolverParams& params) {
+	return Solve(demand, params, SolveControl());
+}
+
+PatternResult Solve(const DemandSet& demand, const SolverParams& params, const SolveControl& control) {
+	if (demand.items.empty()) return PatternResult();
+	bool interrupted = false;
+	const Internal::PlanResult plan = SolveDemand(demand, params, control, interrupted);
+	return Internal::ToPatternResult(plan, interrupted);
+}
+
+SolverResult ExpandResult(const PatternResult& result, const DemandSet& demand) {
+	// Доски одного раскроя ссылаются на один диапазон cuts
+	SolverResult out;
+	size_t boardCount = 0;
+	size_t cutCount = 0;
+	for (size_t p = 0; p < result.patterns.size(); ++p) {
+		boardCount += static_cast<size_t>(std::max(result.patterns[p].count, 0));
+		cutCount += result.patterns[p].cutsMM.size();
+	}
+	out.boards.reserve(boardCount);
+	out.cuts.reserve(cutCount);
+	for (size_t p = 0; p < result.patterns.size(); ++p) {
+		const CutPattern& cp = result.patterns[p];
+		ResultBoard rb;
+		rb.firstCut = static_cast<UInt32>(out.cuts.size());
+		rb.cutCount = static_cast<UInt32>(cp.cutsMM.size());
+		out.cuts.insert(out.cuts.end(), cp.cutsMM.begin(), cp.cutsMM.end());
+		rb.remainder = cp.remainder;
+		rb.boardW = cp.boardW;
+		rb.stockType = cp.stockType;
+		rb.stockLength = cp.stockLength;
+		rb.materialId = cp.materialId;
+		for (Int32 k = 0; k < cp.count; ++k) out.boards.push_back(rb);
+	}
+	for (size_t i = 0; i < result.remaining.size(); ++i) {
+		const PartDemand& d = result.remaining[i];
+		const std::string material = d.materialId < demand.materials.size() ? demand.materials[d.materialId] : std::string();
+		for (Int32 k = 0; k < d.count; ++k)
+			out.remaining.push_back({ static_cast<double>(d.lengthMM), material, d.boardW });
+	}
+	out.bounds = result.bounds;
+	out.interrupted = result.interrupted;
+	return out;
+}
+
+SolverParams ApplyExtraLength(const SolverParams& params, double extraLenMM) {
+	SolverParams out = params;
+	const double extra = (extraLenMM > 0.0 ? extraLenMM : 0.0);
+	double baseMax = 0.0;
+	for (size_t t = 0; t < out.stockTypes.size(); ++t) {
+		out.stockTypes[t].length += extra;
+		if (out.stockTypes[t].length > baseMax)
+			baseMax = out.stockTypes[t].length;
+	}
+	out.maxStockLength = (baseMax > 0.0 ? baseMax : 6000.0 + extra);
+	return out;
 }
 
 } // namespace CuttingStock
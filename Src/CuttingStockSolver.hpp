@@ -1,40 +1,200 @@
 #ifndef CUTTINGSTOCKSOLVER_HPP
 #define CUTTINGSTOCKSOLVER_HPP
 
-#include "GSRoot.hpp"
-#include "UniString.hpp"
-#include "Array.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Ядро раскроя не зависит от Archicad DevKit: std-контейнеры, строки в UTF-8, длины деталей в целых мм.
+// Преобразование из GS-типов надстройки — в SolverAdapter.
 
 namespace CuttingStock {
 
+using Int32 = std::int32_t;
+using UInt32 = std::uint32_t;
+using Int64 = std::int64_t;
+using UInt64 = std::uint64_t;
+
+/** Версия алгоритмов решателя: увеличивать при любом изменении, от которого меняется план (сбрасывает кэш решений). */
+const UInt32 kSolverVersion = 1;
+
 struct Part {
-	double length;
-	GS::UniString material;
+	double length;          // округляется до целых мм
+	std::string material;   // UTF-8
 	double boardW;  // iHeight — ширина доски для отображения/группировки
 };
 
+// Строка агрегированного спроса: count одинаковых деталей.
+struct PartDemand {
+	Int32 lengthMM;
+	UInt32 materialId;   // индекс в DemandSet::materials
+	double boardW;
+	Int32 count;
+};
+
+// Спрос в агрегированном виде: материал хранится один раз в таблице, детали — строками с количеством.
+struct DemandSet {
+	std::vector<std::string> materials;
+	std::vector<PartDemand> items;
+};
+
+/** Добавить count деталей; строки с одинаковыми (длина в мм, материал, boardW) сливаются. */
+void AddDemand(DemandSet& demand, double length, const std::string& material, double boardW, Int32 count = 1);
+
+// Тип заготовки (раздел «Порядок заготовок» плана).
+struct StockType {
+	double length;     // мм
+	double cost;       // относительная стоимость одной заготовки
+	Int32 available;   // доступное количество; < 0 — без ограничения
+	Int32 priority;    // очередность выбора: меньше — раньше (при равной цене)
+	double boardW;     // ширина, для которой есть такая заготовка; 0 — для любой
+	std::string material;   // материал (деловой остаток); пусто — для любого
+};
+
+enum class SolverMode {
+	Greedy,            // Best-Fit Decreasing (по умолчанию)
+	ColumnGeneration,  // LP Гилмора–Гомори + округление + жадная доупаковка остатка
+	SequentialValueCorrection   // SVC: раскрои рюкзаком по корректируемым ценам деталей, лучший из svcPasses проходов
+};
+
 struct SolverParams {
-	double maxStockLength;
+	double maxStockLength;          // единственная длина, если stockTypes пуст
+	std::vector<StockType> stockTypes;
 	double slit;
 	double trimLoss;
 	double usefulMin;   // A — остаток >= usefulMin считается полезным
 	double wasteMax;    // B — остаток <= wasteMax считается отходом
 	bool strictAB;
-	int maxImproveIter;
+	int maxImproveIter;  // лимит попыток локального улучшения (0 — без улучшения)
+	int improveTimeMs;   // лимит времени на улучшение, мс (0 — только по итерациям)
+	SolverMode mode;
+	bool groupByMaterial;  // решать группы (boardW, material) раздельно, а не только по boardW
+	Int32 threadCount;     // потоков для независимых групп; 0 — по числу ядер, 1 — последовательно
+	Int32 exactNodeLimit;  // бюджет узлов точного B&B для малых групп (0 — точный режим выключен)
+	int exactTimeMs;       // лимит времени точного режима на группу, мс (0 — только по узлам)
+	int patternReduceIter;      // лимит проверок при сокращении числа раскроев (0 — без сокращения)
+	double patternWasteWeight;  // цена доски с отходом (0 < остаток <= B) в «раскроях»: 0 — только раскрои
+	Int32 svcPasses;            // проходов SequentialValueCorrection (0 — 10)
 };
 
+// Доска плана; распилы хранятся в общем массиве BoardTable::cuts.
 struct ResultBoard {
-	GS::Array<double> cuts;
+	UInt32 firstCut;      // распилы — cuts[firstCut, firstCut + cutCount), мм
+	UInt32 cutCount;
+	double remainder;
+	double boardW;
+	Int32 stockType;      // индекс в SolverParams::stockTypes (0, если список пуст)
+	double stockLength;   // длина использованной заготовки, мм
+	Int32 materialId = -1;   // при groupByMaterial — индекс в DemandSet::materials; -1 — группа без материала
+};
+
+// Нижняя оценка числа досок группы (ширина, при groupByMaterial — и материал) и достигнутый результат.
+struct GroupBound {
+	double boardW;
+	std::string material;   // пусто, если группы только по ширине
+	Int32 l1;                 // ⌈Σ(length + slit) / (L - trimLoss + slit)⌉
+	Int32 l2;                 // Martello–Toth L2 (не меньше L1)
+	Int32 boards;             // досок группы в плане
+	double gap;               // (boards - l2) / l2; 0 — план оптимален по числу досок
+	bool optimal;             // минимальность числа досок доказана (gap == 0 или полный перебор B&B)
+};
+
+// Доски с распилами подряд в одном массиве: на план — два выделения памяти, а не по одному на доску.
+struct BoardTable {
+	std::vector<ResultBoard> boards;
+	std::vector<Int32> cuts;   // распилы досок подряд, мм; у одинаковых досок диапазон может быть общим
+
+	std::span<const Int32> Cuts(size_t board) const
+	{
+		return std::span<const Int32>(cuts.data() + boards[board].firstCut, boards[board].cutCount);
+	}
+
+	/** Добавить доску; firstCut и cutCount берутся по boardCuts. */
+	void AddBoard(ResultBoard board, std::span<const Int32> boardCuts)
+	{
+		board.firstCut = static_cast<UInt32>(cuts.size());
+		board.cutCount = static_cast<UInt32>(boardCuts.size());
+		cuts.insert(cuts.end(), boardCuts.begin(), boardCuts.end());
+		boards.push_back(board);
+	}
+};
+
+struct SolverResult : BoardTable {
+	std::vector<Part> remaining;
+	std::vector<GroupBound> bounds;
+	bool interrupted = false;   // отмена или дедлайн: план полный, но улучшение прервано на лучшем найденном
+};
+
+// Одинаковые доски раскроя — одной строкой с кратностью.
+struct CutPattern {
+	std::vector<Int32> cutsMM;
 	double remainder;
 	double boardW;
+	Int32 stockType;
+	double stockLength;
+	Int32 materialId;     // как ResultBoard::materialId
+	Int32 count;          // сколько таких досок
 };
 
-struct SolverResult {
-	GS::Array<ResultBoard> boards;
-	GS::Array<Part> remaining;
+struct PatternResult {
+	std::vector<CutPattern> patterns;
+	std::vector<PartDemand> remaining;   // materialId — по таблице исходного DemandSet
+	std::vector<GroupBound> bounds;
+	bool interrupted = false;          // как SolverResult::interrupted
+};
+
+/** Флаг отмены; Cancel() можно вызывать из любого потока. */
+class CancelToken {
+public:
+	void Cancel() { cancelled.store(true); }
+	bool IsCancelled() const { return cancelled.load(); }
+
+private:
+	std::atomic<bool> cancelled{ false };
 };
 
-SolverResult Solve(const GS::Array<Part>& parts, const SolverParams& params);
+enum class SolvePhase {
+	Greedy,
+	ColumnGeneration,
+	ValueCorrection,
+	Improve,
+	Exact,
+	ReducePatterns,
+	Done              // все группы решены (последний вызов)
+};
+
+struct SolveProgress {
+	SolvePhase phase;    // фаза, которую группа только что закончила
+	Int32 groupsDone;
+	Int32 groupCount;
+	Int32 boards;        // досок в лучшем плане на сейчас по группам, у которых план уже есть
+};
+
+// Управление долгим решением. Жадный план каждой группы строится всегда (это миллисекунды);
+// после отмены или дедлайна column generation, улучшение, точный перебор и сокращение раскроев
+// останавливаются с лучшим найденным, и результат помечается interrupted.
+struct SolveControl {
+	const CancelToken* cancel = nullptr;
+	std::function<void(const SolveProgress&)> onProgress;   // из потоков решателя, по одному вызову за раз
+	int timeLimitMs = 0;                                     // общий лимит от начала Solve, мс (0 — без лимита)
+};
+
+SolverResult Solve(const std::vector<Part>& parts, const SolverParams& params);
+SolverResult Solve(const std::vector<Part>& parts, const SolverParams& params, const SolveControl& control);
+
+/** Решение по агрегированному спросу; поштучные детали не создаются. */
+PatternResult Solve(const DemandSet& demand, const SolverParams& params);
+PatternResult Solve(const DemandSet& demand, const SolverParams& params, const SolveControl& control);
+
+/** Развернуть раскрой по доскам и деталям (для экспорта). */
+SolverResult ExpandResult(const PatternResult& result, const DemandSet& demand);
+
+/** Параметры с допуском по длине: длины заготовок + extraLenMM, maxStockLength — по самой длинной. */
+SolverParams ApplyExtraLength(const SolverParams& params, double extraLenMM);
 
 } // namespace CuttingStock
 
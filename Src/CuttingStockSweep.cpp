@@ -0,0 +1,165 @@
+#include "CuttingStockSweep.hpp"
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+
+namespace CuttingStock {
+
+namespace {
+
+// Различные значения оси в порядке первого появления; пустая ось — значение задания
+template <typename T>
+static std::vector<T> AxisValues(const std::vector<T>& values, T fallback)
+{
+	std::vector<T> out;
+	if (values.empty())
+		out.push_back(fallback);
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (std::find(out.begin(), out.end(), values[i]) == out.end())
+			out.push_back(values[i]);
+	}
+	return out;
+}
+
+struct SweepAxes {
+	std::vector<double> slits;
+	std::vector<double> extras;
+	std::vector<double> usefuls;
+	std::vector<double> wastes;
+	std::vector<bool> stricts;
+
+	// Значения осей различны, поэтому все точки их произведения — тоже
+	size_t PointCount() const { return slits.size() * extras.size() * usefuls.size() * wastes.size() * stricts.size(); }
+};
+
+static SweepAxes BuildAxes(const CuttingJob::Job& job, const SweepSpec& spec)
+{
+	const SolverParams& p = job.params;
+	SweepAxes axes;
+	axes.slits = AxisValues(spec.slit, p.slit);
+	axes.extras = AxisValues(spec.extraLenMM, job.extraLenMM);
+	axes.usefuls = AxisValues(spec.usefulMin, p.usefulMin);
+	axes.wastes = AxisValues(spec.wasteMax, p.wasteMax);
+	axes.stricts = AxisValues(spec.strictAB, p.strictAB);
+	return axes;
+}
+
+static std::vector<SweepPoint> BuildPoints(const SweepAxes& axes)
+{
+	std::vector<SweepPoint> points;
+	points.reserve(axes.PointCount());
+	for (double slit : axes.slits)
+		for (double extra : axes.extras)
+			for (double useful : axes.usefuls)
+				for (double waste : axes.wastes)
+					for (bool strict : axes.stricts)
+						points.push_back({ slit, extra, useful, waste, strict });
+	return points;
+}
+
+static void Measure(SweepPlan& plan, double usefulMin)
+{
+	const PatternResult& r = plan.result;
+	for (size_t i = 0; i < r.patterns.size(); ++i) {
+		const CutPattern& pat = r.patterns[i];
+		plan.boards += pat.count;
+		if (pat.remainder >= usefulMin)
+			plan.usefulOffcuts += pat.count;
+		else
+			plan.wasteMM += pat.remainder * pat.count;
+		std::vector<Int32> lengths = pat.cutsMM;
+		std::sort(lengths.begin(), lengths.end());
+		plan.setups += static_cast<Int32>(std::unique(lengths.begin(), lengths.end()) - lengths.begin());
+	}
+	for (size_t i = 0; i < r.remaining.size(); ++i)
+		plan.unplaced += r.remaining[i].count;
+}
+
+// a не хуже b по всем показателям (отход — с точностью до 0.5 мм)
+static bool NoWorse(const SweepPlan& a, const SweepPlan& b)
+{
+	return a.boards <= b.boards && a.wasteMM <= b.wasteMM + 0.5 && a.setups <= b.setups && a.usefulOffcuts >= b.usefulOffcuts;
+}
+
+} // anonymous
+
+std::vector<double> SweepValues(double from, double to, double step)
+{
+	std::vector<double> values;
+	values.push_back(from);
+	if (step <= 0.0 || to <= from)
+		return values;
+	// i * step, а не накопление: без дрейфа на длинных сетках
+	for (size_t i = 1; from + static_cast<double>(i) * step <= to + 1e-9 && values.size() <= kSweepMaxPoints; ++i)
+		values.push_back(from + static_cast<double>(i) * step);
+	return values;
+}
+
+size_t SweepPointCount(const CuttingJob::Job& job, const SweepSpec& spec)
+{
+	return BuildAxes(job, spec).PointCount();
+}
+
+SweepResult Sweep(const CuttingJob::Job& job, const SweepSpec& spec, const SolveControl& control)
+{
+	SweepResult out;
+	const SweepAxes axes = BuildAxes(job, spec);
+	if (axes.PointCount() > kSweepMaxPoints) {
+		out.tooLarge = true;
+		return out;
+	}
+	const std::vector<SweepPoint> points = BuildPoints(axes);
+
+	std::vector<SolverParams> paramsList;
+	for (size_t i = 0; i < points.size(); ++i) {
+		CuttingJob::Job pointJob;
+		pointJob.params = job.params;
+		pointJob.params.slit = points[i].slit;
+		pointJob.params.usefulMin = points[i].usefulMin;
+		pointJob.params.wasteMax = points[i].wasteMax;
+		pointJob.params.strictAB = points[i].strictAB;
+		pointJob.extraLenMM = points[i].extraLenMM;
+		pointJob.offcutStock = job.offcutStock;
+		paramsList.push_back(CuttingJob::SolveParams(pointJob));
+	}
+
+	std::vector<bool> interrupted;
+	std::vector<Internal::PlanResult> plans = Internal::SolveDemandBatch(job.demand, paramsList, control, interrupted);
+	out.plans.resize(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		SweepPlan& plan = out.plans[i];
+		plan.point = points[i];
+		plan.result = Internal::ToPatternResult(plans[i], interrupted[i]);
+		Measure(plan, job.params.usefulMin);
+		out.interrupted = out.interrupted || interrupted[i];
+	}
+
+	// Фронт Парето среди полных (насколько возможно) планов
+	Int32 minUnplaced = 0;
+	for (size_t i = 0; i < out.plans.size(); ++i)
+		minUnplaced = (i == 0 ? out.plans[i].unplaced : std::min(minUnplaced, out.plans[i].unplaced));
+	for (size_t i = 0; i < out.plans.size(); ++i) {
+		const SweepPlan& a = out.plans[i];
+		if (a.unplaced != minUnplaced) continue;
+		bool dominated = false;
+		for (size_t j = 0; j < out.plans.size() && !dominated; ++j) {
+			const SweepPlan& b = out.plans[j];
+			if (j == i || b.unplaced != minUnplaced || !NoWorse(b, a)) continue;
+			// Строго лучше хотя бы в одном — или такой же, но раньше в сетке
+			dominated = !NoWorse(a, b) || j < i;
+		}
+		if (!dominated) {
+			out.plans[i].pareto = true;
+			out.front.push_back(i);
+		}
+	}
+	std::stable_sort(out.front.begin(), out.front.end(), [&out](size_t a, size_t b) {
+		const SweepPlan& pa = out.plans[a];
+		const SweepPlan& pb = out.plans[b];
+		if (pa.boards != pb.boards) return pa.boards < pb.boards;
+		if (pa.wasteMM != pb.wasteMM) return pa.wasteMM < pb.wasteMM;
+		return pa.setups < pb.setups;
+	});
+	return out;
+}
+
+} // namespace CuttingStock
@@ -0,0 +1,69 @@
+#ifndef CUTTINGSTOCKSWEEP_HPP
+#define CUTTINGSTOCKSWEEP_HPP
+
+#include "CuttingStockJob.hpp"
+#include <cstddef>
+#include <vector>
+
+// Подбор параметров: одно задание решается на сетке значений (пропил, допуск по длине, пороги A/B,
+// strictAB), и из планов выбирается фронт Парето. Группы спроса строятся один раз на всю сетку,
+// задачи всех точек решаются одним пулом потоков.
+
+namespace CuttingStock {
+
+/** Больше точек сетки Sweep не решает (результат пустой, tooLarge). */
+const size_t kSweepMaxPoints = 1000;
+
+/** Значения from, from + step, ... не больше to; step <= 0 или to <= from — только from. */
+std::vector<double> SweepValues(double from, double to, double step);
+
+// Сетка подбора: декартово произведение списков; пустой список — значение из задания.
+struct SweepSpec {
+	std::vector<double> slit;
+	std::vector<double> extraLenMM;
+	std::vector<double> usefulMin;
+	std::vector<double> wasteMax;
+	std::vector<bool> strictAB;
+};
+
+struct SweepPoint {
+	double slit;
+	double extraLenMM;
+	double usefulMin;
+	double wasteMax;
+	bool strictAB;
+};
+
+// План точки сетки и его показатели. Остатки оцениваются по порогам задания, а не точки,
+// иначе планы с разными A/B нельзя сравнивать.
+struct SweepPlan {
+	SweepPoint point;
+	PatternResult result;
+	Int32 boards = 0;
+	Int32 unplaced = 0;          // деталей не размещено
+	double wasteMM = 0.0;        // сумма остатков < usefulMin задания
+	Int32 usefulOffcuts = 0;     // досок с остатком >= usefulMin задания
+	Int32 setups = 0;            // установок упора: сумма различных длин по раскроям
+	bool pareto = false;
+};
+
+struct SweepResult {
+	std::vector<SweepPlan> plans;   // в порядке сетки, без повторяющихся точек
+	std::vector<size_t> front;      // индексы plans фронта Парето: по доскам, отходу, установкам
+	bool interrupted = false;       // отмена или лимит control: часть планов без улучшения
+	bool tooLarge = false;          // точек больше kSweepMaxPoints
+};
+
+/** Число различных точек сетки для задания — произведение числа различных значений осей, без ограничения
+ *  kSweepMaxPoints (при большем числе Sweep возвращает tooLarge, не решая). */
+size_t SweepPointCount(const CuttingJob::Job& job, const SweepSpec& spec);
+
+/** Решить задание во всех точках сетки (параметры точки — вместо параметров задания, остальное — как в
+ *  CuttingJob::SolveParams). Фронт: среди планов с наименьшим числом неразмещённых — не хуже других
+ *  по доскам, отходу, установкам и полезным остаткам; планы с одинаковыми показателями — один раз.
+ *  control.timeLimitMs — на всю сетку, onProgress — по группам всех точек. */
+SweepResult Sweep(const CuttingJob::Job& job, const SweepSpec& spec, const SolveControl& control);
+
+} // namespace CuttingStock
+
+#endif
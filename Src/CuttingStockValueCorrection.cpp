@@ -0,0 +1,198 @@
+#include "CuttingStockInternal.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Sequential Value Correction (Мухачева; Belov–Scheithauer) для одной ширины boardW.
+// Раскрои строятся по одному: ограниченный рюкзак по текущим ценам деталей y_i на остаток спроса,
+// раскрой берётся столько раз, сколько позволяет спрос. После каждого раскроя цены его деталей
+// сдвигаются к «норме расхода» — доле заготовки вместе с отходом, которую деталь в нём заняла.
+// Цены переходят в следующий проход, поэтому детали, которые плохо укладываются, дорожают
+// и в следующих проходах раскраиваются раньше. Из проходов остаётся лучший план.
+// Длины, заготовки, рюкзак и доупаковка — общие с column generation (PatternGroup).
+
+namespace CuttingStock {
+namespace Internal {
+
+namespace {
+
+const Int32 kDefaultPasses = 10;
+const double kEps = 1e-9;
+
+// План одного прохода: раскрои с кратностью; детали, которые рюкзак не разместил, — в left
+struct PassPlan {
+	std::vector<std::pair<std::vector<Int32>, size_t>> patterns;   // (число деталей каждой длины, stocks)
+	std::vector<Int32> copies;
+	std::vector<Int32> left;
+	double cost = 0.0;
+	Int32 boards = 0;
+};
+
+// Рюкзак по ценам values на остаток left. Тип заготовки — с наибольшей ценой раскроя на единицу стоимости;
+// при равенстве — меньший остаток, затем priority. false — ни один раскрой с допустимым остатком не найден.
+static bool BestPattern(const PatternGroup& group, const std::vector<double>& values, const std::vector<Int32>& left,
+	const std::vector<Int32>& stockLeft, PatternKnapsack& knapsack, std::vector<Int32>& outCounts, size_t& outStock)
+{
+	knapsack.Solve(group.items, values, left, group.maxCapacity);
+
+	Int32 bestW = -1;
+	double bestRatio = 0.0;
+	for (size_t st = 0; st < group.stocks.size(); ++st) {
+		if (stockLeft[st] == 0) continue;
+		const Int32 stockCap = group.stocks[st].capacity;
+		for (Int32 w = stockCap; w > 0; --w) {
+			// Меньшие веса этого типа не дадут даже равного отношения
+			if (knapsack.BestUpTo(w) <= 0.0 || (bestW >= 0 && knapsack.BestUpTo(w) / group.stocks[st].cost <= bestRatio - kEps)) break;
+			const double value = knapsack.Best(w);
+			if (value <= 0.0 || !ValidRemainder(stockCap - w, *group.params)) continue;
+			const double ratio = value / group.stocks[st].cost;
+			bool better = bestW < 0 || ratio > bestRatio + kEps;
+			if (!better && ratio > bestRatio - kEps) {
+				const Int32 rem = stockCap - w;
+				const Int32 bestRem = group.stocks[outStock].capacity - bestW;
+				better = rem < bestRem || (rem == bestRem && group.stocks[st].priority < group.stocks[outStock].priority);
+			}
+			if (better) {
+				bestRatio = ratio;
+				bestW = w;
+				outStock = st;
+			}
+		}
+	}
+	if (bestW <= 0) return false;
+
+	knapsack.Counts(bestW, outCounts);
+	return true;
+}
+
+// Один проход SVC; values корректируются на месте. false — прерван по ctx.Stopped().
+static bool RunPass(const PatternGroup& group, double exponent, std::vector<double>& values, const SolveContext& solve,
+	PatternKnapsack& knapsack, PassPlan& plan)
+{
+	const std::vector<PatternItem>& items = group.items;
+	const size_t m = items.size();
+	std::vector<Int32> stockLeft(group.stocks.size());
+	for (size_t st = 0; st < group.stocks.size(); ++st) stockLeft[st] = group.stocks[st].left;
+	plan.left.resize(m);
+	for (size_t i = 0; i < m; ++i) plan.left[i] = items[i].demand;
+
+	std::vector<Int32> counts;
+	for (;;) {
+		if (solve.Stopped()) return false;
+		size_t stock = 0;
+		if (!BestPattern(group, values, plan.left, stockLeft, knapsack, counts, stock))
+			break;
+
+		// Раскрой повторяется, пока хватает спроса и заготовок
+		Int32 copies = stockLeft[stock] < 0 ? INT32_MAX : stockLeft[stock];
+		Int32 used = 0;
+		for (size_t i = 0; i < m; ++i) {
+			if (counts[i] == 0) continue;
+			copies = std::min(copies, plan.left[i] / counts[i]);
+			used += counts[i] * items[i].weight;
+		}
+		const double share = static_cast<double>(group.stocks[stock].capacity) / used;
+		for (size_t i = 0; i < m; ++i) {
+			if (counts[i] == 0) continue;
+			// Новая цена — норма расхода детали в этом раскрое; вес старой — уже раскроенные детали
+			const double norm = items[i].weight * std::pow(share, exponent);
+			const double done = static_cast<double>(items[i].demand - plan.left[i]);
+			const double added = static_cast<double>(counts[i]) * copies;
+			values[i] = (values[i] * done + norm * added) / (done + added);
+			plan.left[i] -= counts[i] * copies;
+		}
+		if (stockLeft[stock] > 0) stockLeft[stock] -= copies;
+		plan.patterns.push_back({ counts, stock });
+		plan.copies.push_back(copies);
+		plan.cost += group.stocks[stock].cost * copies;
+		plan.boards += copies;
+	}
+	return true;
+}
+
+// Меньше неразмещённых деталей, затем дешевле, затем меньше досок
+static bool IsBetterPass(const PassPlan& a, const PassPlan& b)
+{
+	Int64 leftA = 0;
+	Int64 leftB = 0;
+	for (Int32 n : a.left) leftA += n;
+	for (Int32 n : b.left) leftB += n;
+	if (leftA != leftB) return leftA < leftB;
+	if (a.cost < b.cost - kEps) return true;
+	if (a.cost > b.cost + kEps) return false;
+	return a.boards < b.boards;
+}
+
+// Проходы SVC, лучший план — в result, его заготовки списываются с group.stocks.
+// Детали, не вошедшие в раскрои, возвращаются в residual группы.
+static void SolveGroup(PatternGroup& group, const SolveContext& solve, PlanResult& result)
+{
+	const std::vector<PatternItem>& items = group.items;
+	const SolverParams& params = *group.params;
+
+	// Проход достиг нижней оценки — следующие ничего не дадут
+	Int32 lowerBound = 0;
+	if (BoardCountIsObjective(group.stock, group.boardW)) {
+		std::vector<BoundItem> boundItems;
+		for (const PatternItem& it : items) boundItems.push_back({ it.weight, it.demand });
+		lowerBound = ComputeLowerBounds(boundItems, group.maxCapacity).l2;
+	}
+
+	// Первый проход — цены по весу, дальше показатель нормы расхода случайно в [1, 1.2]: проходы расходятся,
+	// а план воспроизводим (генератор с фиксированным зерном)
+	const Int32 passes = params.svcPasses > 0 ? params.svcPasses : kDefaultPasses;
+	std::vector<double> values(items.size());
+	for (size_t i = 0; i < items.size(); ++i) values[i] = items[i].weight;
+	std::mt19937 rng(static_cast<std::mt19937::result_type>(items.size() * 7919 + static_cast<size_t>(items[0].length)));
+	std::uniform_real_distribution<double> exponentDist(1.0, 1.2);
+	PatternKnapsack knapsack;
+	PassPlan best;
+	bool haveBest = false;
+	const PhaseBudget budget(params.improveTimeMs);
+	for (Int32 pass = 0; pass < passes; ++pass) {
+		// Первый проход — всегда (его план сравнивается с жадным), следующие — пока не вышел лимит группы
+		if (pass > 0 && budget.Expired())
+			break;
+		const double exponent = pass == 0 ? 1.0 : exponentDist(rng);
+		PassPlan plan;
+		if (!RunPass(group, exponent, values, solve, knapsack, plan))
+			break;
+		if (!haveBest || IsBetterPass(plan, best)) {
+			best = std::move(plan);
+			haveBest = true;
+		}
+		bool complete = true;
+		for (Int32 n : best.left) complete = complete && n == 0;
+		if (complete && lowerBound > 0 && best.boards <= lowerBound)
+			break;
+	}
+	if (!haveBest) {
+		// Ни один проход не завершён — группа целиком уходит жадному алгоритму
+		for (const PatternItem& it : items) AddResidual(group, it, 0);
+		return;
+	}
+
+	for (size_t p = 0; p < best.patterns.size(); ++p)
+		AddPatternBoards(group, items, best.patterns[p].first, best.patterns[p].second, best.copies[p], result);
+	for (size_t i = 0; i < items.size(); ++i)
+		AddResidual(group, items[i], items[i].demand - best.left[i]);
+}
+
+} // anonymous
+
+PlanResult SolveValueCorrection(const DemandSet& demand, const SolverParams& params, const SolveContext& solve)
+{
+	PlanResult result;
+	if (demand.items.empty()) return result;
+
+	PatternGroup group = BuildPatternGroup(demand, params);
+	if (!group.items.empty())
+		SolveGroup(group, solve, result);
+	FinishPatternGroup(group, result);
+	return result;
+}
+
+} // namespace Internal
+} // namespace CuttingStock
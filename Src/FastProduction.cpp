@@ -1,6 +1,12 @@
 #include "FastProduction.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <tuple>
+#include <unordered_map>
 
 namespace FastProduction {
 
@@ -14,81 +20,90 @@ static int RoundToStep(double value, int stepMm)
 	return static_cast<int>(std::round(v));
 }
 
-static void NormalizeCuts(const GS::Array<double>& cuts, int roundStepMm, GS::Array<int>& out)
+static void NormalizeCuts(std::span<const Int32> cuts, int roundStepMm, std::vector<int>& out)
 {
-	out.Clear();
-	for (UIndex i = 0; i < cuts.GetSize(); ++i) {
-		double c = cuts[i];
-		if (c != c || c <= 0.0)  // NaN or non-positive
+	out.clear();
+	for (size_t i = 0; i < cuts.size(); ++i) {
+		if (cuts[i] <= 0)
 			continue;
-		int len = RoundToStep(c, roundStepMm);
+		int len = RoundToStep(cuts[i], roundStepMm);
 		if (len > 0)
-			out.Push(len);
+			out.push_back(len);
 	}
 }
 
-static void SortLengthsDesc(GS::Array<int>& lengths)
-{
-	for (UIndex i = 0; i < lengths.GetSize(); ++i) {
-		for (UIndex j = i + 1; j < lengths.GetSize(); ++j) {
-			if (lengths[j] > lengths[i]) {
-				int t = lengths[i];
-				lengths[i] = lengths[j];
-				lengths[j] = t;
-			}
-		}
+// Canonical scenario key: BoardW in 0.001 mm, then (stopLength, count) of every run
+using ScenarioKey = std::vector<Int64>;
+
+struct ScenarioKeyHash {
+	size_t operator()(const ScenarioKey& key) const
+	{
+		size_t h = key.size();
+		for (Int64 v : key)
+			h ^= std::hash<Int64>()(v) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		return h;
 	}
-}
+};
 
-static int CountScenarioSetups(const GS::UniString& scenarioOps)
+static void MakeScenarioKey(double boardW, const std::vector<Run>& runs, ScenarioKey& key)
 {
-	GS::Array<Run> runs;
-	ParseScenarioOps(scenarioOps, runs);
-	return static_cast<int>(runs.GetSize());
+	key.clear();
+	key.push_back(CuttingStock::SizeKey(boardW));
+	for (const Run& r : runs) {
+		key.push_back(r.stopLength);
+		key.push_back(r.count);
+	}
 }
 
 } // anonymous
 
-GS::UniString ComputeBoardScenarioOps(const GS::Array<double>& cuts, int roundStepMm, bool sortDesc)
+void ComputeBoardRuns(std::span<const Int32> cuts, int roundStepMm, bool sortDesc, std::vector<Run>& outRuns)
 {
-	GS::Array<int> lengths;
+	std::vector<int> lengths;
 	NormalizeCuts(cuts, roundStepMm, lengths);
-	if (lengths.IsEmpty())
-		return GS::UniString();
-
+	outRuns.clear();
 	if (sortDesc)
-		SortLengthsDesc(lengths);
-
-	GS::UniString result;
-	int runLen = lengths[0];
-	int runCount = 1;
-	for (UIndex i = 1; i <= lengths.GetSize(); ++i) {
-		int cur = (i < lengths.GetSize()) ? lengths[i] : -1;
-		if (i < lengths.GetSize() && cur == runLen) {
-			++runCount;
-		} else {
-			if (!result.IsEmpty())
-				result += "|";
-			result += GS::UniString::Printf("%dx%d", runLen, runCount);
-			if (i < lengths.GetSize()) {
-				runLen = cur;
-				runCount = 1;
-			}
-		}
+		std::sort(lengths.begin(), lengths.end(), std::greater<int>());
+	for (size_t i = 0; i < lengths.size(); ++i) {
+		if (!outRuns.empty() && outRuns.back().stopLength == lengths[i])
+			++outRuns.back().count;
+		else
+			outRuns.push_back({ lengths[i], 1 });
+	}
+}
+
+std::string FormatScenarioOps(std::span<const Run> runs)
+{
+	std::string result;
+	for (size_t r = 0; r < runs.size(); ++r) {
+		if (r > 0)
+			result += "|";
+		result += std::to_string(runs[r].stopLength) + "x" + std::to_string(runs[r].count);
 	}
 	return result;
 }
 
-void ParseScenarioOps(const GS::UniString& scenarioOps, GS::Array<Run>& outRuns)
+std::string FormatScenarioId(const ScenarioRecord& scenario)
 {
-	outRuns.Clear();
-	GS::UniString s = scenarioOps;
-	s.Trim();
-	if (s.IsEmpty())
-		return;
+	char buf[64];
+	std::snprintf(buf, sizeof(buf), "W%.0f_S%02d", scenario.boardW, scenario.localIndex);
+	return buf;
+}
 
-	const char* p = s.ToCStr().Get();
-	if (!p)
+std::string ComputeBoardScenarioOps(std::span<const Int32> cuts, int roundStepMm, bool sortDesc)
+{
+	std::vector<Run> runs;
+	ComputeBoardRuns(cuts, roundStepMm, sortDesc, runs);
+	return FormatScenarioOps(runs);
+}
+
+void ParseScenarioOps(const std::string& scenarioOps, std::vector<Run>& outRuns)
+{
+	outRuns.clear();
+	const char* p = scenarioOps.c_str();
+	while (*p == ' ' || *p == '\t')
+		++p;
+	if (*p == '\0')
 		return;
 
 	for (;;) {
@@ -99,7 +114,7 @@ void ParseScenarioOps(const GS::UniString& scenarioOps, GS::Array<Run>& outRuns)
 			Run r;
 			r.stopLength = len;
 			r.count = count;
-			outRuns.Push(r);
+			outRuns.push_back(r);
 			p += n;
 		} else {
 			break;
@@ -111,7 +126,104 @@ void ParseScenarioOps(const GS::UniString& scenarioOps, GS::Array<Run>& outRuns)
 	}
 }
 
-ScenarioData BuildScenarioData(const CuttingStock::SolverResult& result, int roundStepMm, bool sortDesc, UInt32 minGroupSize)
+#ifdef DEBUG
+namespace {
+// (scenario, stop, cuts) of every row, sorted: equal for two set lists with the same runs
+static std::vector<std::tuple<std::string, int, int>> RunKeys(const std::vector<SetListRow>& rows)
+{
+	std::vector<std::tuple<std::string, int, int>> keys;
+	for (const SetListRow& row : rows)
+		keys.push_back({ row.scenarioId, row.stopLength, row.cutsCount });
+	std::sort(keys.begin(), keys.end());
+	return keys;
+}
+
+// seqOrder numbers the rows 1..N in set list order
+static bool IsSequential(const std::vector<SetListRow>& rows)
+{
+	for (size_t i = 0; i < rows.size(); ++i) {
+		if (rows[i].seqOrder != static_cast<int>(i) + 1) return false;
+	}
+	return true;
+}
+
+static bool RunFastProductionTests()
+{
+	std::vector<Int32> cuts1;
+	cuts1.push_back(3000);
+	cuts1.push_back(3000);
+	std::string ops1 = ComputeBoardScenarioOps(cuts1, 1, true);
+	if (ops1 != "3000x2") return false;
+
+	std::vector<Int32> cuts2;
+	cuts2.push_back(3090);
+	cuts2.push_back(590);
+	cuts2.push_back(590);
+	cuts2.push_back(590);
+	cuts2.push_back(590);
+	cuts2.push_back(549);
+	std::string ops2 = ComputeBoardScenarioOps(cuts2, 1, true);
+	if (ops2 != "3090x1|590x4|549x1") return false;
+
+	std::vector<Run> runs;
+	ParseScenarioOps(std::string("3000x2"), runs);
+	if (runs.size() != 1 || runs[0].stopLength != 3000 || runs[0].count != 2) return false;
+
+	ParseScenarioOps(std::string("3090x1|590x4|549x1"), runs);
+	if (runs.size() != 3) return false;
+	if (runs[0].stopLength != 3090 || runs[0].count != 1) return false;
+	if (runs[1].stopLength != 590 || runs[1].count != 4) return false;
+	if (runs[2].stopLength != 549 || runs[2].count != 1) return false;
+
+	// SequenceSetups / ScheduleStations: fewer or equal setups, every run cut exactly once
+	const Int32 patterns[][4] = {
+		{ 3000, 1500, 1500, 0 }, { 1500, 1200, 800, 800 }, { 3000, 800, 0, 0 }, { 2000, 2000, 1200, 0 },
+		{ 1200, 1200, 800, 0 }, { 2000, 1500, 0, 0 }, { 3000, 1200, 0, 0 }, { 800, 800, 800, 800 }
+	};
+	CuttingStock::BoardTable table;
+	for (int copy = 0; copy < 3; ++copy) {
+		for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+			if (copy > 0 && p % 3 == 0) continue;
+			std::vector<Int32> cuts;
+			for (Int32 len : patterns[p]) {
+				if (len > 0) cuts.push_back(len);
+			}
+			CuttingStock::ResultBoard rb = {};
+			rb.boardW = p % 2 == 0 ? 100.0 : 150.0;
+			rb.stockLength = 6000.0;
+			table.AddBoard(rb, cuts);
+		}
+	}
+	ScenarioData data = BuildScenarioData(table, 1, true, 2);
+	const std::vector<SetListRow> unsequenced = data.setListRows;
+	SequenceSetups(data);
+	if (data.setupsAfter > data.setupsBefore) return false;
+	if (RunKeys(data.setListRows) != RunKeys(unsequenced) || !IsSequential(data.setListRows)) return false;
+
+	StationParams stationParams;
+	stationParams.count = 3;
+	ScheduleStations(data, stationParams);
+	if (data.stations.size() != 3) return false;
+	Int64 totalCuts = 0;
+	for (const SetListRow& row : data.setListRows) totalCuts += row.cutsCount;
+	Int64 stationCuts = 0;
+	size_t stationScenarios = 0;
+	std::vector<SetListRow> stationRows;
+	for (const StationPlan& plan : data.stations) {
+		if (!IsSequential(plan.setListRows)) return false;
+		stationCuts += plan.cuts;
+		stationScenarios += plan.scenarios.size();
+		stationRows.insert(stationRows.end(), plan.setListRows.begin(), plan.setListRows.end());
+	}
+	if (stationCuts != totalCuts || stationScenarios != data.scenarios.size()) return false;
+	if (RunKeys(stationRows) != RunKeys(unsequenced)) return false;
+
+	return true;
+}
+} // anonymous
+#endif
+
+ScenarioData BuildScenarioData(const CuttingStock::BoardTable& result, int roundStepMm, bool sortDesc, UInt32 minGroupSize)
 {
 #ifdef DEBUG
 	static bool testsRun = false;
@@ -121,230 +233,91 @@ ScenarioData BuildScenarioData(const CuttingStock::SolverResult& result, int rou
 	}
 #endif
 	ScenarioData data;
-	if (result.boards.IsEmpty())
+	if (result.boards.empty())
 		return data;
 
 	const int kRoundStep = (roundStepMm > 0) ? roundStepMm : 1;
+	const size_t boardCount = result.boards.size();
 
-	// Per-board ScenarioOps
-	GS::Array<GS::UniString> opsList;
-	opsList.SetSize(result.boards.GetSize());
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		const CuttingStock::ResultBoard& rb = result.boards[b];
-		opsList[b] = ComputeBoardScenarioOps(rb.cuts, kRoundStep, sortDesc);
-	}
+	// Scenarios in order of first board; runs of a new scenario are appended to data.runs
+	std::unordered_map<ScenarioKey, UInt32, ScenarioKeyHash> scenarioIndex;
+	std::unordered_map<Int64, int> scenariosPerWidth;   // next local index S{nn} per BoardW
+	data.boardScenario.resize(boardCount);
 
-	// Unique (BoardW, ScenarioOps) -> scenario index, and board count per scenario
-	struct ScenarioKey {
-		double boardW;
-		GS::UniString scenarioOps;
-		bool operator==(const ScenarioKey& o) const {
-			return std::fabs(boardW - o.boardW) < 0.001 && scenarioOps == o.scenarioOps;
-		}
-	};
-	GS::Array<ScenarioKey> uniqueKeys;
-	GS::Array<UIndex> boardToScenarioIndex;
-	boardToScenarioIndex.SetSize(result.boards.GetSize());
-
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		double boardW = result.boards[b].boardW;
-		const GS::UniString& ops = opsList[b];
-		ScenarioKey key;
-		key.boardW = boardW;
-		key.scenarioOps = ops;
-
-		UIndex idx = uniqueKeys.GetSize();
-		for (UIndex k = 0; k < uniqueKeys.GetSize(); ++k) {
-			if (uniqueKeys[k] == key) {
-				idx = k;
-				break;
-			}
-		}
-		if (idx == uniqueKeys.GetSize())
-			uniqueKeys.Push(key);
-		boardToScenarioIndex[b] = idx;
-	}
-
-	// Count boards per scenario
-	GS::Array<UInt32> scenarioBoardCount;
-	scenarioBoardCount.SetSize(uniqueKeys.GetSize());
-	for (UIndex k = 0; k < scenarioBoardCount.GetSize(); ++k)
-		scenarioBoardCount[k] = 0;
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		UIndex k = boardToScenarioIndex[b];
-		scenarioBoardCount[k] += 1;
-	}
-
-	// ScenarioId: W{BoardW}_S{index:02d} per (BoardW) group
-	GS::Array<Int32> scenarioIdPerKey;
-	scenarioIdPerKey.SetSize(uniqueKeys.GetSize());
-	GS::Array<double> distinctBoardWs;
-	for (UIndex k = 0; k < uniqueKeys.GetSize(); ++k) {
-		double w = uniqueKeys[k].boardW;
-		bool found = false;
-		for (UIndex d = 0; d < distinctBoardWs.GetSize(); ++d) {
-			if (std::fabs(distinctBoardWs[d] - w) < 0.001) { found = true; break; }
-		}
-		if (!found)
-			distinctBoardWs.Push(w);
-	}
-	// Sort distinct widths
-	for (UIndex i = 0; i < distinctBoardWs.GetSize(); ++i) {
-		for (UIndex j = i + 1; j < distinctBoardWs.GetSize(); ++j) {
-			if (distinctBoardWs[j] < distinctBoardWs[i]) {
-				double t = distinctBoardWs[i];
-				distinctBoardWs[i] = distinctBoardWs[j];
-				distinctBoardWs[j] = t;
-			}
-		}
-	}
-	GS::Array<Int32> scenarioIndexPerBoardW;
-	for (UIndex k = 0; k < uniqueKeys.GetSize(); ++k) {
-		double w = uniqueKeys[k].boardW;
-		Int32 localIdx = 0;
-		for (UIndex d = 0; d < distinctBoardWs.GetSize(); ++d) {
-			if (std::fabs(distinctBoardWs[d] - w) < 0.001) {
-				for (UIndex j = 0; j < k; ++j) {
-					if (std::fabs(uniqueKeys[j].boardW - w) < 0.001)
-						++localIdx;
-				}
-				break;
-			}
-		}
-		scenarioIdPerKey[k] = localIdx;
-	}
-	// Recompute local index per width
-	GS::Array<GS::UniString> scenarioIds;
-	scenarioIds.SetSize(uniqueKeys.GetSize());
-	for (UIndex k = 0; k < uniqueKeys.GetSize(); ++k) {
-		double w = uniqueKeys[k].boardW;
-		Int32 localIdx = 0;
-		for (UIndex j = 0; j < k; ++j) {
-			if (std::fabs(uniqueKeys[j].boardW - w) < 0.001)
-				++localIdx;
+	std::vector<Run> runs;
+	ScenarioKey key;
+	for (size_t b = 0; b < boardCount; ++b) {
+		const CuttingStock::ResultBoard& rb = result.boards[b];
+		ComputeBoardRuns(result.Cuts(b), kRoundStep, sortDesc, runs);
+		MakeScenarioKey(rb.boardW, runs, key);
+		auto found = scenarioIndex.find(key);
+		if (found == scenarioIndex.end()) {
+			const int localIndex = scenariosPerWidth[key[0]]++;
+			data.scenarioTable.push_back({ rb.boardW, localIndex, static_cast<UInt32>(data.runs.size()),
+				static_cast<UInt32>(runs.size()), 0, rb.remainder, false });
+			data.runs.insert(data.runs.end(), runs.begin(), runs.end());
+			found = scenarioIndex.emplace(key, static_cast<UInt32>(data.scenarioTable.size() - 1)).first;
 		}
-		scenarioIds[k] = GS::UniString::Printf("W%.0f_S%02d", w, localIdx);
+		data.boardScenario[b] = found->second;
+		data.scenarioTable[found->second].boardsCount += 1;
 	}
+	for (ScenarioRecord& sc : data.scenarioTable)
+		sc.fast = sc.boardsCount >= minGroupSize;
+
+	// Set list rows, scenario steps and the (BoardW, StopLength) summary in order of first appearance
+	std::unordered_map<ScenarioKey, size_t, ScenarioKeyHash> summaryIndex;
+	for (size_t s = 0; s < data.scenarioTable.size(); ++s) {
+		const ScenarioRecord& sc = data.scenarioTable[s];
+		const std::span<const Run> scRuns = data.Runs(s);
+		const int boardsCount = static_cast<int>(sc.boardsCount);
+		ScenarioInfo info;
+		info.scenarioId = FormatScenarioId(sc);
+		info.boardW = sc.boardW;
+		info.boardsCount = boardsCount;
+		info.remainderMm = sc.remainderMm;
 
-	// Fill per-board data
-	data.boardScenarioId.SetSize(result.boards.GetSize());
-	data.boardScenarioOps.SetSize(result.boards.GetSize());
-	data.boardScenarioSetups.SetSize(result.boards.GetSize());
-	data.boardScenarioGroup.SetSize(result.boards.GetSize());
-
-	for (UIndex b = 0; b < result.boards.GetSize(); ++b) {
-		UIndex k = boardToScenarioIndex[b];
-		data.boardScenarioId[b] = scenarioIds[k];
-		data.boardScenarioOps[b] = opsList[b];
-		data.boardScenarioSetups[b] = CountScenarioSetups(opsList[b]);
-		data.boardScenarioGroup[b] = (scenarioBoardCount[k] >= minGroupSize) ? GS::UniString("FAST") : GS::UniString("TAIL");
-	}
-
-	// Set list rows and summary
-	GS::Array<double> summaryKeysBoardW;
-	GS::Array<int> summaryKeysStop;
-	GS::Array<int> summaryTotals;
-
-	for (UIndex k = 0; k < uniqueKeys.GetSize(); ++k) {
-		GS::Array<Run> runs;
-		ParseScenarioOps(uniqueKeys[k].scenarioOps, runs);
-		const int boardsCount = static_cast<int>(scenarioBoardCount[k]);
-		const double boardW = uniqueKeys[k].boardW;
-		const GS::UniString& scenarioId = scenarioIds[k];
-
-		for (UIndex r = 0; r < runs.GetSize(); ++r) {
+		for (size_t r = 0; r < scRuns.size(); ++r) {
+			const Run& run = scRuns[r];
 			SetListRow row;
-			row.boardW = boardW;
-			row.scenarioId = scenarioId;
-			row.stopLength = runs[r].stopLength;
-			row.cutsCount = runs[r].count * boardsCount;
+			row.boardW = sc.boardW;
+			row.scenarioId = info.scenarioId;
+			row.stopLength = run.stopLength;
+			row.cutsCount = run.count * boardsCount;
 			row.boardsCount = boardsCount;
 			row.opOrder = static_cast<int>(r + 1);
-			data.setListRows.Push(row);
-
-			// Summary aggregate
-			bool found = false;
-			for (UIndex s = 0; s < summaryKeysBoardW.GetSize(); ++s) {
-				if (std::fabs(summaryKeysBoardW[s] - boardW) < 0.001 && summaryKeysStop[s] == runs[r].stopLength) {
-					summaryTotals[s] += runs[r].count * boardsCount;
-					found = true;
-					break;
-				}
-			}
-			if (!found) {
-				summaryKeysBoardW.Push(boardW);
-				summaryKeysStop.Push(runs[r].stopLength);
-				summaryTotals.Push(runs[r].count * boardsCount);
-			}
-		}
+			row.seqOrder = static_cast<int>(data.setListRows.size() + 1);
+			data.setListRows.push_back(row);
+
+			key.assign({ CuttingStock::SizeKey(sc.boardW), run.stopLength });
+			const auto summary = summaryIndex.emplace(key, data.setListSummaryRows.size());
+			if (summary.second)
+				data.setListSummaryRows.push_back({ sc.boardW, run.stopLength, 0 });
+			data.setListSummaryRows[summary.first->second].totalCuts += run.count * boardsCount;
 
-		// ScenarioInfo for operator instructions
-		ScenarioInfo info;
-		info.scenarioId = scenarioId;
-		info.boardW = boardW;
-		info.boardsCount = boardsCount;
-		info.remainderMm = 0.0;
-		for (UIndex bb = 0; bb < result.boards.GetSize(); ++bb) {
-			if (boardToScenarioIndex[bb] == k) {
-				info.remainderMm = result.boards[bb].remainder;
-				break;
-			}
-		}
-		for (UIndex r = 0; r < runs.GetSize(); ++r) {
 			ScenarioStepInfo si;
-			si.stopLength = runs[r].stopLength;
-			si.cutsPerBoard = runs[r].count;
-			si.totalCuts = runs[r].count * boardsCount;
+			si.stopLength = run.stopLength;
+			si.cutsPerBoard = run.count;
+			si.totalCuts = run.count * boardsCount;
 			si.opOrder = static_cast<int>(r + 1);
-			info.steps.Push(si);
+			info.steps.push_back(si);
 		}
-		data.scenarios.Push(info);
+		data.scenarios.push_back(info);
 	}
 
-	for (UIndex s = 0; s < summaryKeysBoardW.GetSize(); ++s) {
-		SetListSummaryRow sr;
-		sr.boardW = summaryKeysBoardW[s];
-		sr.stopLength = summaryKeysStop[s];
-		sr.totalCuts = summaryTotals[s];
-		data.setListSummaryRows.Push(sr);
+	// Stop changes in discovery order (SequenceSetups improves on them)
+	int lastStop = -1;
+	for (const SetListRow& row : data.setListRows) {
+		if (row.stopLength == lastStop)
+			continue;
+		data.setupsBefore += 1;
+		if (lastStop >= 0)
+			data.travelBeforeMm += std::llabs(static_cast<Int64>(row.stopLength) - lastStop);
+		lastStop = row.stopLength;
 	}
+	data.setupsAfter = data.setupsBefore;
+	data.travelAfterMm = data.travelBeforeMm;
 
 	return data;
 }
 
-#ifdef DEBUG
-namespace {
-static bool RunFastProductionTests()
-{
-	GS::Array<double> cuts1;
-	cuts1.Push(3000.0);
-	cuts1.Push(3000.0);
-	GS::UniString ops1 = ComputeBoardScenarioOps(cuts1, 1, true);
-	if (ops1 != "3000x2") return false;
-
-	GS::Array<double> cuts2;
-	cuts2.Push(3090.0);
-	cuts2.Push(590.0);
-	cuts2.Push(590.0);
-	cuts2.Push(590.0);
-	cuts2.Push(590.0);
-	cuts2.Push(549.0);
-	GS::UniString ops2 = ComputeBoardScenarioOps(cuts2, 1, true);
-	if (ops2 != "3090x1|590x4|549x1") return false;
-
-	GS::Array<Run> runs;
-	ParseScenarioOps(GS::UniString("3000x2"), runs);
-	if (runs.GetSize() != 1 || runs[0].stopLength != 3000 || runs[0].count != 2) return false;
-
-	ParseScenarioOps(GS::UniString("3090x1|590x4|549x1"), runs);
-	if (runs.GetSize() != 3) return false;
-	if (runs[0].stopLength != 3090 || runs[0].count != 1) return false;
-	if (runs[1].stopLength != 590 || runs[1].count != 4) return false;
-	if (runs[2].stopLength != 549 || runs[2].count != 1) return false;
-
-	return true;
-}
-} // anonymous
-#endif
-
 } // namespace FastProduction
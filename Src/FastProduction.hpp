@@ -1,20 +1,25 @@
 #ifndef FASTPRODUCTION_HPP
 #define FASTPRODUCTION_HPP
 
-#include "GSRoot.hpp"
-#include "UniString.hpp"
-#include "Array.hpp"
 #include "CuttingStockSolver.hpp"
+#include <span>
+#include <string>
+#include <vector>
 
 namespace FastProduction {
 
+using CuttingStock::Int32;
+using CuttingStock::UInt32;
+using CuttingStock::Int64;
+
 struct SetListRow {
 	double boardW;
-	GS::UniString scenarioId;
+	std::string scenarioId;
 	int stopLength;
 	int cutsCount;
 	int boardsCount;
-	int opOrder;
+	int opOrder;      // run order within the scenario
+	int seqOrder;     // global operation order on the saw (1-based)
 };
 
 struct SetListSummaryRow {
@@ -31,36 +36,125 @@ struct ScenarioStepInfo {
 };
 
 struct ScenarioInfo {
-	GS::UniString scenarioId;
+	std::string scenarioId;
 	double boardW;
 	int boardsCount;
 	double remainderMm;
-	GS::Array<ScenarioStepInfo> steps;
+	std::vector<ScenarioStepInfo> steps;
 };
 
-struct ScenarioData {
-	GS::Array<GS::UniString> boardScenarioId;
-	GS::Array<GS::UniString> boardScenarioOps;
-	GS::Array<Int32> boardScenarioSetups;
-	GS::Array<GS::UniString> boardScenarioGroup;
-	GS::Array<SetListRow> setListRows;
-	GS::Array<SetListSummaryRow> setListSummaryRows;
-	GS::Array<ScenarioInfo> scenarios;
+// Crosscut stations working in parallel and the time estimate per scenario.
+struct StationParams {
+	Int32 count = 1;
+	double secondsPerCut = 6.0;
+	double secondsPerSetup = 60.0;   // one stop change
 };
 
-/** Build ScenarioOps string from cuts: e.g. "3000x2" or "3090x1|590x4|549x1". */
-GS::UniString ComputeBoardScenarioOps(const GS::Array<double>& cuts, int roundStepMm, bool sortDesc);
-
-/** Build full scenario data from solver result. */
-ScenarioData BuildScenarioData(const CuttingStock::SolverResult& result, int roundStepMm, bool sortDesc, UInt32 minGroupSize);
+// Work of one station: its scenarios in the order they are cut (SequenceSetups within the station).
+struct StationPlan {
+	std::vector<ScenarioInfo> scenarios;
+	std::vector<SetListRow> setListRows;   // seqOrder — within the station
+	Int32 setups = 0;
+	Int64 cuts = 0;
+	double seconds = 0.0;                  // cuts * secondsPerCut + setups * secondsPerSetup
+};
 
 struct Run {
 	int stopLength;
 	int count;
 };
 
+// Distinct (BoardW, runs) pattern; its runs are ScenarioData::runs[firstRun, firstRun + runCount).
+struct ScenarioRecord {
+	double boardW;
+	int localIndex;       // S{nn} of the id within the BoardW
+	UInt32 firstRun;
+	UInt32 runCount;      // ScenarioSetups
+	UInt32 boardsCount;
+	double remainderMm;   // first board of the scenario
+	bool fast;            // boardsCount >= minGroupSize: FAST, otherwise TAIL
+};
+
+struct ScenarioData {
+	std::vector<UInt32> boardScenario;          // per board: index in scenarioTable
+	std::vector<ScenarioRecord> scenarioTable;  // in order of the first board
+	std::vector<Run> runs;                      // runs of all scenarios, contiguous
+	std::vector<SetListRow> setListRows;
+	std::vector<SetListSummaryRow> setListSummaryRows;
+	std::vector<ScenarioInfo> scenarios;
+	Int32 setupsBefore = 0;     // stop changes in scenario discovery order
+	Int32 setupsAfter = 0;      // stop changes in the order of setListRows/scenarios
+	Int64 travelBeforeMm = 0;   // total stop travel, mm
+	Int64 travelAfterMm = 0;
+	std::vector<StationPlan> stations;   // ScheduleStations; empty — a single saw works the whole set list
+
+	std::span<const Run> Runs(size_t scenario) const
+	{
+		const ScenarioRecord& sc = scenarioTable[scenario];
+		return std::span<const Run>(runs.data() + sc.firstRun, sc.runCount);
+	}
+};
+
+/** Runs of equal lengths from cuts (rounded to roundStepMm, sorted descending if sortDesc). */
+void ComputeBoardRuns(std::span<const Int32> cuts, int roundStepMm, bool sortDesc, std::vector<Run>& outRuns);
+
+/** Format runs as ScenarioOps text: e.g. "3000x2" or "3090x1|590x4|549x1". */
+std::string FormatScenarioOps(std::span<const Run> runs);
+
+/** Scenario id text of a table entry: e.g. "W145_S03". */
+std::string FormatScenarioId(const ScenarioRecord& scenario);
+
+/** Build ScenarioOps string from cuts: e.g. "3000x2" or "3090x1|590x4|549x1". */
+std::string ComputeBoardScenarioOps(std::span<const Int32> cuts, int roundStepMm, bool sortDesc);
+
+/** Build full scenario data from solver result in one pass over the boards: scenarios are keyed
+ *  by (BoardW, runs) in a hash table; per board only the scenario index is stored, per-board text
+ *  is left to the writers. */
+ScenarioData BuildScenarioData(const CuttingStock::BoardTable& result, int roundStepMm, bool sortDesc, UInt32 minGroupSize);
+
+/** Reorder scenarios (within width groups, groups in order of first appearance) and their runs to
+ *  minimise stop changes, then stop travel: nearest neighbour + 2-opt over shared stop lengths.
+ *  Rebuilds setListRows from scenarios in the global operation order; setupsBefore/After report the gain.
+ *  The order is kept if the heuristic does not improve it. entryStop — the stop the saw is already on
+ *  (-1: none); it is not counted as a setup. */
+void SequenceSetups(ScenarioData& data, int entryStop = -1);
+
+/** Assign scenarios to params.count stations minimising the makespan: LPT on the estimate
+ *  (cuts * secondsPerCut + runs * secondsPerSetup), then moves and swaps off the busiest station.
+ *  Each station's scenarios are then sequenced with SequenceSetups. count <= 1 clears stations. */
+void ScheduleStations(ScenarioData& data, const StationParams& params);
+
+/** BuildScenarioData + SequenceSetups fed one complete width group at a time, so that only the
+ *  current group is held in memory. Groups are sequenced from the stop the previous one ended on,
+ *  seqOrder and setup counts continue across groups. */
+class ScenarioStream {
+public:
+	ScenarioStream(int roundStepMm, bool sortDesc, UInt32 minGroupSize);
+
+	/** Scenarios of the next width group (all boards of that BoardW); valid until the next call. */
+	const ScenarioData& AddWidthGroup(const CuttingStock::BoardTable& boards);
+
+	Int32 SetupsBefore() const { return setupsBefore; }
+	Int32 SetupsAfter() const { return setupsAfter; }
+	Int64 TravelBeforeMm() const { return travelBeforeMm; }
+	Int64 TravelAfterMm() const { return travelAfterMm; }
+
+private:
+	int roundStepMm;
+	bool sortDesc;
+	UInt32 minGroupSize;
+	ScenarioData group;
+	int seqOrder = 0;
+	int lastStopBefore = -1;   // discovery order
+	int lastStopAfter = -1;    // sequenced order: the stop the saw is on
+	Int32 setupsBefore = 0;
+	Int32 setupsAfter = 0;
+	Int64 travelBeforeMm = 0;
+	Int64 travelAfterMm = 0;
+};
+
 /** Parse ScenarioOps string into runs (e.g. "3000x2|590x4" -> Run array). */
-void ParseScenarioOps(const GS::UniString& scenarioOps, GS::Array<Run>& outRuns);
+void ParseScenarioOps(const std::string& scenarioOps, std::vector<Run>& outRuns);
 
 } // namespace FastProduction
 
@@ -0,0 +1,390 @@
+#include "FastProductionExport.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace FastProduction {
+
+namespace {
+
+static void AppendLine(std::string& txt, const char* fmt, ...)
+{
+	char buf[1024];
+	va_list args;
+	va_start(args, fmt);
+	const int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	if (n > 0)
+		txt.append(buf, static_cast<size_t>(n) < sizeof(buf) ? static_cast<size_t>(n) : sizeof(buf) - 1);
+}
+
+// Ключ (толщина, ширина, длина) в целых единицах: std::map сразу даёт порядок по толщине, ширине, длине
+struct CutSummaryRow {
+	double boardTmm;
+	double boardWmm;
+	double cutLenMM;
+	unsigned count;
+};
+using CutSummaryKey = std::tuple<Int64, Int64, Int32>;
+using CutSummaryMap = std::map<CutSummaryKey, CutSummaryRow>;
+
+const char* const kSetListHeader = "BoardW;ScenarioId;StopLength;CutsCount;BoardsCount;OpOrder;SeqOrder\r\n";
+const char* const kSetListSummaryHeader = "BoardW;StopLength;TotalCuts\r\n";
+
+static void AppendCutPlanHeader(std::string& csv, size_t maxCuts, bool withScenarios)
+{
+	csv += "Board;BoardW;";
+	for (size_t c = 0; c < maxCuts; ++c)
+		AppendLine(csv, "Cut%u;", (unsigned)(c + 1));
+	csv += "Remainder;Kerf;StockL";
+	if (withScenarios)
+		csv += ";ScenarioId;ScenarioOps;ScenarioSetups;ScenarioGroup";
+	csv += "\r\n";
+}
+
+// Строка доски; столбцы сценария — если у scenarioData есть доска b
+static void AppendBoardRow(std::string& csv, size_t boardNo, const CuttingStock::ResultBoard& rb, std::span<const Int32> cuts,
+	size_t maxCuts, double slit, const ScenarioData* scenarioData, size_t b)
+{
+	AppendLine(csv, "%d;%.0f;", (int)boardNo, rb.boardW);
+	for (size_t c = 0; c < maxCuts; ++c) {
+		if (c < cuts.size())
+			AppendLine(csv, "%d;", (int)cuts[c]);
+		else
+			csv += ";";
+	}
+	AppendLine(csv, "%.0f;%.0f;%.0f", rb.remainder, slit, rb.stockLength);
+	if (scenarioData && b < scenarioData->boardScenario.size()) {
+		// Текст сценария — из таблицы сценариев, по индексу доски
+		const UInt32 s = scenarioData->boardScenario[b];
+		const ScenarioRecord& sc = scenarioData->scenarioTable[s];
+		csv += ";";
+		csv += FormatScenarioId(sc);
+		csv += ";";
+		csv += FormatScenarioOps(scenarioData->Runs(s));
+		AppendLine(csv, ";%u;%s", (unsigned)sc.runCount, sc.fast ? "FAST" : "TAIL");
+	}
+	csv += "\r\n";
+}
+
+static void AddCutSummary(CutSummaryMap& rows, const CuttingStock::ProfileTable& profiles, double boardWmm, std::span<const Int32> cuts)
+{
+	const double boardTmm = profiles.ThicknessForWidth(boardWmm);      // толщина
+	const Int64 tKey = CuttingStock::SizeKey(boardTmm);
+	const Int64 wKey = CuttingStock::SizeKey(boardWmm);
+	for (Int32 cut : cuts) {
+		if (cut <= 0)
+			continue;
+		CutSummaryRow& row = rows.try_emplace(CutSummaryKey(tKey, wKey, cut), CutSummaryRow{ boardTmm, boardWmm, static_cast<double>(cut), 0 }).first->second;
+		row.count += 1;
+	}
+}
+
+static void AppendRemainingRow(std::string& csv, double length, double boardW, const std::string& material)
+{
+	AppendLine(csv, "%.0f;%.0f;", length, boardW);
+	csv += material;
+	csv += "\r\n";
+}
+
+// Сводки после остатка деталей: по пиломатериалам и по отрезкам
+static void AppendCsvSummaries(std::string& csv, const std::vector<SectionRow>& sections, const CutSummaryMap& cutSummary)
+{
+	// Сводка по пиломатериалам: толщина/ширина, количество и объём в м3
+	csv += "\r\n";
+	csv += "Material summary (boardT_mm;boardW_mm;count;volume_m3)\r\n";
+	for (size_t i = 0; i < sections.size(); ++i) {
+		const SectionRow& row = sections[i];
+		const double boardTmm = row.thicknessMM;
+		const double boardWmm = row.widthMM;
+		const double maxLenMM = (row.maxLenMM > 0.0 ? row.maxLenMM : 6000.0);
+		double boardsCountD = 0.0;
+		if (maxLenMM > 0.0 && row.totalLenMM > 0.0)
+			boardsCountD = std::ceil(row.totalLenMM / maxLenMM);
+		const unsigned boardsCount = boardsCountD > 0.0 ? (unsigned)boardsCountD : 0u;
+
+		const double boardTm = boardTmm / 1000.0;
+		const double boardWm = boardWmm / 1000.0;
+		const double maxLenM = maxLenMM / 1000.0;
+		const double volumeM3 = boardsCount * maxLenM * boardTm * boardWm;
+		AppendLine(csv, "%.0f;%.0f;%u;%.3f\r\n", boardTmm, boardWmm, boardsCount, volumeM3);
+	}
+
+	// Сводка по отрезкам: толщина/ширина доски и длина отрезка
+	csv += "\r\n";
+	csv += "Cut summary (boardT_mm;boardW_mm;cutLen_mm;count)\r\n";
+	for (const auto& entry : cutSummary) {
+		const CutSummaryRow& r = entry.second;
+		AppendLine(csv, "%.0f;%.0f;%.0f;%u\r\n", r.boardTmm, r.boardWmm, r.cutLenMM, r.count);
+	}
+}
+
+static void AppendSetListRows(std::string& csv, const std::vector<SetListRow>& rows)
+{
+	for (size_t i = 0; i < rows.size(); ++i) {
+		const SetListRow& row = rows[i];
+		AppendLine(csv, "%.0f;%s;%d;%d;%d;%d;%d\r\n",
+			row.boardW, row.scenarioId.c_str(), row.stopLength, row.cutsCount, row.boardsCount, row.opOrder, row.seqOrder);
+	}
+}
+
+static void AppendSetListSummaryRows(std::string& csv, const std::vector<SetListSummaryRow>& rows)
+{
+	for (size_t i = 0; i < rows.size(); ++i) {
+		const SetListSummaryRow& row = rows[i];
+		AppendLine(csv, "%.0f;%d;%d\r\n", row.boardW, row.stopLength, row.totalCuts);
+	}
+}
+
+} // anonymous
+
+CuttingStock::ProfileTable SectionProfiles(const std::vector<SectionRow>& sections)
+{
+	CuttingStock::ProfileTable profiles;
+	for (size_t i = 0; i < sections.size(); ++i)
+		profiles.Intern(sections[i].thicknessMM, sections[i].widthMM, std::string());
+	return profiles;
+}
+
+std::string BuildCutPlanCsv(const CuttingStock::SolverResult& result, double slit,
+	const std::vector<SectionRow>& sections, ScenarioData* outScenarioData)
+{
+	std::string csv;
+	if (outScenarioData) {
+		*outScenarioData = BuildScenarioData(result, 1, true, 2);
+		SequenceSetups(*outScenarioData);
+	}
+
+	// Определяем максимальное количество отрезков на доску,
+	// чтобы сформировать заголовок Cut1..CutN и строки полной ширины.
+	size_t maxCuts = 0;
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		if (result.boards[b].cutCount > maxCuts)
+			maxCuts = result.boards[b].cutCount;
+	}
+
+	AppendCutPlanHeader(csv, maxCuts, outScenarioData != nullptr);
+	const CuttingStock::ProfileTable profiles = SectionProfiles(sections);
+	CutSummaryMap cutSummary;
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		AppendBoardRow(csv, b + 1, result.boards[b], result.Cuts(b), maxCuts, slit, outScenarioData, b);
+		AddCutSummary(cutSummary, profiles, result.boards[b].boardW, result.Cuts(b));
+	}
+	csv += "\r\n";
+	csv += "Remaining parts (length;boardW;material)\r\n";
+	for (size_t i = 0; i < result.remaining.size(); ++i) {
+		const CuttingStock::Part& p = result.remaining[i];
+		AppendRemainingRow(csv, p.length, p.boardW, p.material);
+	}
+	AppendCsvSummaries(csv, sections, cutSummary);
+	return csv;
+}
+
+std::string BuildSetListCsv(const ScenarioData& scenarioData)
+{
+	std::string csv = kSetListHeader;
+	AppendSetListRows(csv, scenarioData.setListRows);
+	return csv;
+}
+
+std::string BuildStationSetListCsv(const StationPlan& station)
+{
+	std::string csv = kSetListHeader;
+	AppendSetListRows(csv, station.setListRows);
+	return csv;
+}
+
+std::string BuildSetListSummaryCsv(const ScenarioData& scenarioData)
+{
+	std::string csv = kSetListSummaryHeader;
+	AppendSetListSummaryRows(csv, scenarioData.setListSummaryRows);
+	return csv;
+}
+
+// Программа распила одного сценария: доски и шаги по упорам
+static void AppendScenarioProgram(std::string& txt, const ScenarioInfo& info, const CuttingStock::ProfileTable& profiles)
+{
+	const double thickness = profiles.ThicknessForWidth(info.boardW);
+	AppendLine(txt, "--- %s (\u0411\u0435\u0440\u0451\u043C %d \u0434\u043E\u0441\u043E\u043A %.0fx%.0f \u043C\u043C) ---\r\n",
+		info.scenarioId.c_str(), info.boardsCount, thickness, info.boardW);
+	const bool oneSetup = (info.steps.size() == 1);
+	for (size_t r = 0; r < info.steps.size(); ++r) {
+		const ScenarioStepInfo& step = info.steps[r];
+		const bool isFirst = (r == 0);
+		const bool isLast = (r == info.steps.size() - 1);
+		if (oneSetup) {
+			AppendLine(txt, "\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u043F\u0438\u043B\u0438\u043C \u0431\u0435\u0437 \u043E\u0441\u0442\u0430\u0442\u043A\u0430 (%d \u0440\u0435\u0437\u043E\u0432 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439 \u0434\u043E\u0441\u043A\u0438). ", step.stopLength, step.cutsPerBoard);
+			AppendLine(txt, "\u041E\u0441\u0442\u0430\u0442\u043E\u043A %.0f \u043C\u043C \u043D\u0430 \u0434\u043E\u0441\u043A\u0443. \u0412\u0441\u0435\u0433\u043E %d \u0434\u043E\u0441\u043E\u043A, %d \u0440\u0435\u0437\u043E\u0432.\r\n", info.remainderMm, info.boardsCount, step.totalCuts);
+		} else {
+			if (isFirst) {
+				AppendLine(txt, "\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). \u041E\u0441\u0442\u0430\u0442\u043E\u043A \u043E\u0442\u043A\u043B\u0430\u0434\u044B\u0432\u0430\u0435\u043C \u0432 \u043F\u0430\u0447\u043A\u0443.\r\n", step.stopLength, step.cutsPerBoard);
+			} else if (isLast) {
+				AppendLine(txt, "\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u0431\u0435\u0440\u0451\u043C \u043E\u0441\u0442\u0430\u0442\u043E\u043A \u0438\u0437 \u043F\u0430\u0447\u043A\u0438, \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). ", step.stopLength, step.cutsPerBoard);
+				AppendLine(txt, "\u041E\u0441\u0442\u0430\u0442\u043E\u043A %.0f \u043C\u043C \u043D\u0430 \u0434\u043E\u0441\u043A\u0443.\r\n", info.remainderMm);
+			} else {
+				AppendLine(txt, "\u0423\u043F\u043E\u0440 %d \u043C\u043C \u2014 \u0431\u0435\u0440\u0451\u043C \u043E\u0441\u0442\u0430\u0442\u043E\u043A \u0438\u0437 \u043F\u0430\u0447\u043A\u0438, \u043F\u0438\u043B\u0438\u043C (%d \u0440\u0435\u0437 \u0441 \u043A\u0430\u0436\u0434\u043E\u0439). \u041E\u0441\u0442\u0430\u0442\u043E\u043A \u0432 \u043F\u0430\u0447\u043A\u0443.\r\n", step.stopLength, step.cutsPerBoard);
+			}
+		}
+	}
+	txt += "\r\n";
+}
+
+// Итог досок по ширинам (в порядке первого появления)
+static void AppendBoardTotals(std::string& txt, const std::vector<double>& widths, const std::vector<UInt32>& counts,
+	const CuttingStock::ProfileTable& profiles)
+{
+	AppendLine(txt, "=== \u0412\u0441\u0435\u0433\u043E \u0434\u043E\u0441\u043E\u043A ===\r\n");
+	for (size_t d = 0; d < widths.size(); ++d) {
+		const double boardW = widths[d];
+		const UInt32 count = counts[d];
+		const double thickness = profiles.ThicknessForWidth(boardW);
+		AppendLine(txt, "\u0412\u0441\u0435\u0433\u043E %u \u0448\u0442 %.0fx%.0f \u043C\u043C\r\n", (unsigned)count, thickness, boardW);
+	}
+	txt += "\r\n\r\n";
+}
+
+static void AppendProgramsHeader(std::string& txt, bool hasScenarios, Int32 setupsAfter, Int32 setupsBefore)
+{
+	AppendLine(txt, "=== \u041F\u0440\u043E\u0433\u0440\u0430\u043C\u043C\u044B \u0440\u0430\u0441\u043F\u0438\u043B\u0430 ===\r\n\r\n");
+	if (hasScenarios)
+		AppendLine(txt, "\u0423\u0441\u0442\u0430\u043D\u043E\u0432\u043E\u043A \u0443\u043F\u043E\u0440\u0430: %d (\u0432 \u043F\u043E\u0440\u044F\u0434\u043A\u0435 \u043E\u0431\u043D\u0430\u0440\u0443\u0436\u0435\u043D\u0438\u044F \u0441\u0446\u0435\u043D\u0430\u0440\u0438\u0435\u0432 \u2014 %d)\r\n\r\n", (int)setupsAfter, (int)setupsBefore);
+}
+
+std::string BuildOperatorInstructions(const ScenarioData& scenarioData, const CuttingStock::SolverResult& result,
+	const std::vector<SectionRow>& sections)
+{
+	std::string txt;
+	const CuttingStock::ProfileTable profiles = SectionProfiles(sections);
+	if (!result.boards.empty()) {
+		// Ширины в порядке первого появления и число досок каждой — за один проход
+		std::vector<double> widths;
+		std::vector<UInt32> counts;
+		std::unordered_map<Int64, size_t> widthIndex;
+		for (size_t b = 0; b < result.boards.size(); ++b) {
+			const double w = result.boards[b].boardW;
+			const auto found = widthIndex.emplace(CuttingStock::SizeKey(w), widths.size());
+			if (found.second) {
+				widths.push_back(w);
+				counts.push_back(0);
+			}
+			counts[found.first->second] += 1;
+		}
+		AppendBoardTotals(txt, widths, counts, profiles);
+	}
+
+	if (scenarioData.stations.size() > 1) {
+		// По пилам: у каждой свой порядок сценариев и свои установки упора
+		for (size_t st = 0; st < scenarioData.stations.size(); ++st) {
+			const StationPlan& station = scenarioData.stations[st];
+			AppendLine(txt, "=== \u041F\u0438\u043B\u0430 %u: \u0441\u0446\u0435\u043D\u0430\u0440\u0438\u0435\u0432 %u, \u0440\u0435\u0437\u043E\u0432 %lld, \u0443\u0441\u0442\u0430\u043D\u043E\u0432\u043E\u043A \u0443\u043F\u043E\u0440\u0430 %d, \u2248 %.0f \u043C\u0438\u043D ===\r\n\r\n",
+				(unsigned)(st + 1), (unsigned)station.scenarios.size(), (long long)station.cuts, (int)station.setups, station.seconds / 60.0);
+			for (size_t s = 0; s < station.scenarios.size(); ++s)
+				AppendScenarioProgram(txt, station.scenarios[s], profiles);
+			txt += "\r\n";
+		}
+		return txt;
+	}
+
+	// Сценарии и шаги — в порядке SequenceSetups
+	AppendProgramsHeader(txt, !scenarioData.scenarios.empty(), scenarioData.setupsAfter, scenarioData.setupsBefore);
+	for (size_t s = 0; s < scenarioData.scenarios.size(); ++s)
+		AppendScenarioProgram(txt, scenarioData.scenarios[s], profiles);
+	return txt;
+}
+
+std::string StreamCutPlan(const CuttingStock::PatternResult& patterns, const CuttingStock::DemandSet& demand, double slit,
+	const std::vector<SectionRow>& sections, const CutPlanSinks& sinks)
+{
+	// Раскрои по ширинам в порядке первого появления (решатель выдаёт их по ширине) — без разворота по доскам
+	std::vector<double> widths;
+	std::vector<UInt32> counts;
+	std::vector<std::vector<size_t>> groups;
+	std::unordered_map<Int64, size_t> widthIndex;
+	size_t maxCuts = 0;
+	for (size_t p = 0; p < patterns.patterns.size(); ++p) {
+		const CuttingStock::CutPattern& cp = patterns.patterns[p];
+		if (cp.count <= 0)
+			continue;
+		const auto found = widthIndex.emplace(CuttingStock::SizeKey(cp.boardW), widths.size());
+		if (found.second) {
+			widths.push_back(cp.boardW);
+			counts.push_back(0);
+			groups.push_back({});
+		}
+		counts[found.first->second] += static_cast<UInt32>(cp.count);
+		groups[found.first->second].push_back(p);
+		maxCuts = std::max(maxCuts, cp.cutsMM.size());
+	}
+
+	std::string text;
+	AppendCutPlanHeader(text, maxCuts, true);
+	sinks.csv(text);
+	sinks.setList(kSetListHeader);
+	sinks.setListSummary(kSetListSummaryHeader);
+
+	// Группа ширины целиком: доски (одинаковые — с общим диапазоном cuts), сценарии, строки всех файлов
+	const CuttingStock::ProfileTable profiles = SectionProfiles(sections);
+	CutSummaryMap cutSummary;
+	ScenarioStream stream(1, true, 2);
+	CuttingStock::BoardTable boards;
+	std::string programs;
+	size_t boardNo = 0;
+	for (const std::vector<size_t>& group : groups) {
+		boards.boards.clear();
+		boards.cuts.clear();
+		for (size_t p : group) {
+			const CuttingStock::CutPattern& cp = patterns.patterns[p];
+			CuttingStock::ResultBoard rb;
+			rb.firstCut = static_cast<UInt32>(boards.cuts.size());
+			rb.cutCount = static_cast<UInt32>(cp.cutsMM.size());
+			rb.remainder = cp.remainder;
+			rb.boardW = cp.boardW;
+			rb.stockType = cp.stockType;
+			rb.stockLength = cp.stockLength;
+			rb.materialId = cp.materialId;
+			boards.cuts.insert(boards.cuts.end(), cp.cutsMM.begin(), cp.cutsMM.end());
+			boards.boards.insert(boards.boards.end(), static_cast<size_t>(cp.count), rb);
+		}
+		const ScenarioData& data = stream.AddWidthGroup(boards);
+
+		text.clear();
+		for (size_t b = 0; b < boards.boards.size(); ++b) {
+			AppendBoardRow(text, ++boardNo, boards.boards[b], boards.Cuts(b), maxCuts, slit, &data, b);
+			AddCutSummary(cutSummary, profiles, boards.boards[b].boardW, boards.Cuts(b));
+		}
+		sinks.csv(text);
+		text.clear();
+		AppendSetListRows(text, data.setListRows);
+		sinks.setList(text);
+		text.clear();
+		AppendSetListSummaryRows(text, data.setListSummaryRows);
+		sinks.setListSummary(text);
+		for (size_t s = 0; s < data.scenarios.size(); ++s)
+			AppendScenarioProgram(programs, data.scenarios[s], profiles);
+	}
+
+	text = "\r\n";
+	text += "Remaining parts (length;boardW;material)\r\n";
+	for (size_t i = 0; i < patterns.remaining.size(); ++i) {
+		const CuttingStock::PartDemand& d = patterns.remaining[i];
+		const std::string material = d.materialId < demand.materials.size() ? demand.materials[d.materialId] : std::string();
+		for (Int32 k = 0; k < d.count; ++k)
+			AppendRemainingRow(text, static_cast<double>(d.lengthMM), d.boardW, material);
+	}
+	AppendCsvSummaries(text, sections, cutSummary);
+	sinks.csv(text);
+
+	// Инструкции: итог установок известен только после всех групп
+	std::string txt;
+	if (boardNo > 0)
+		AppendBoardTotals(txt, widths, counts, profiles);
+	AppendProgramsHeader(txt, !programs.empty(), stream.SetupsAfter(), stream.SetupsBefore());
+	txt += programs;
+	return txt;
+}
+
+} // namespace FastProduction
@@ -0,0 +1,61 @@
+#ifndef FASTPRODUCTIONEXPORT_HPP
+#define FASTPRODUCTIONEXPORT_HPP
+
+#include "CuttingStockProfiles.hpp"
+#include "CuttingStockSolver.hpp"
+#include "FastProduction.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Тексты экспорта плана распила (CSV, set list, инструкции оператору) — UTF-8, строки через \r\n.
+// Общие для надстройки и пакетного прогона заданий: файлы получаются одинаковыми.
+
+namespace FastProduction {
+
+// Сечение пиломатериала из выделения (сводка по толщине и ширине).
+struct SectionRow {
+	double thicknessMM;   // iWidth
+	double widthMM;       // iHeight — совпадает с boardW досок плана
+	Int32 count;          // досок этого сечения в выделении
+	double totalLenMM;    // суммарная длина, мм
+	double maxLenMM;      // исходная длина доски (iMaxLen), мм
+};
+
+/** Таблица профилей сечений (без материала) — толщина по ширине доски за O(1). */
+CuttingStock::ProfileTable SectionProfiles(const std::vector<SectionRow>& sections);
+
+/** План по доскам, остаток деталей, сводки по материалу и отрезкам; при outScenarioData — со сценариями. */
+std::string BuildCutPlanCsv(const CuttingStock::SolverResult& result, double slit,
+	const std::vector<SectionRow>& sections, ScenarioData* outScenarioData = nullptr);
+
+/** set_list.csv: шаги сценариев по упорам. */
+std::string BuildSetListCsv(const ScenarioData& scenarioData);
+
+/** <stem>_station<k>_set_list.csv: шаги сценариев одной пилы (ScheduleStations). */
+std::string BuildStationSetListCsv(const StationPlan& station);
+
+/** set_list_summary.csv: резы по (ширина, упор). */
+std::string BuildSetListSummaryCsv(const ScenarioData& scenarioData);
+
+/** Инструкции оператору: итог досок по сечениям и программы распила по сценариям (при нескольких пилах — по пилам). */
+std::string BuildOperatorInstructions(const ScenarioData& scenarioData, const CuttingStock::SolverResult& result,
+	const std::vector<SectionRow>& sections);
+
+// Приёмники потокового экспорта: куски текста файла по порядку (без BOM).
+struct CutPlanSinks {
+	std::function<void(const std::string&)> csv;
+	std::function<void(const std::string&)> setList;
+	std::function<void(const std::string&)> setListSummary;
+};
+
+/** Потоковый экспорт для больших планов: раскрой разворачивается по доскам по одной группе ширины,
+ *  её строки CSV плана, set list и set_list_summary сразу уходят в sinks — в памяти только текущая группа.
+ *  Тексты — как у BuildCutPlanCsv/BuildSetListCsv/BuildSetListSummaryCsv с одной пилой; порядок упоров
+ *  выбирается по каждой группе (ScenarioStream). Возвращает инструкции оператору. */
+std::string StreamCutPlan(const CuttingStock::PatternResult& patterns, const CuttingStock::DemandSet& demand, double slit,
+	const std::vector<SectionRow>& sections, const CutPlanSinks& sinks);
+
+} // namespace FastProduction
+
+#endif
@@ -0,0 +1,116 @@
+#include "FastProduction.hpp"
+#include <algorithm>
+
+// Scenarios on several crosscut stations: identical parallel machines, makespan minimisation.
+// A scenario is never split between stations (its boards are cut run after run on one saw).
+
+namespace FastProduction {
+
+namespace {
+
+const int kMaxImproveSteps = 10000;
+const double kEps = 1e-9;
+
+static Int64 ScenarioCuts(const ScenarioInfo& info)
+{
+	Int64 cuts = 0;
+	for (const ScenarioStepInfo& s : info.steps) cuts += s.totalCuts;
+	return cuts;
+}
+
+// One move or swap off the busiest station that lowers the larger of the two loads; false — none found
+static bool ImproveOnce(const std::vector<double>& times, std::vector<size_t>& stationOf, std::vector<double>& load)
+{
+	const size_t busiest = static_cast<size_t>(std::max_element(load.begin(), load.end()) - load.begin());
+	const double peak = load[busiest];
+	size_t bestA = times.size();
+	size_t bestB = times.size();
+	size_t bestTo = load.size();
+	double bestPeak = peak;
+	for (size_t a = 0; a < times.size(); ++a) {
+		if (stationOf[a] != busiest) continue;
+		for (size_t to = 0; to < load.size(); ++to) {
+			if (to == busiest) continue;
+			const double moved = std::max(peak - times[a], load[to] + times[a]);
+			if (moved < bestPeak - kEps) {
+				bestPeak = moved;
+				bestA = a;
+				bestB = times.size();
+				bestTo = to;
+			}
+		}
+		for (size_t b = 0; b < times.size(); ++b) {
+			const size_t to = stationOf[b];
+			if (to == busiest || times[b] >= times[a]) continue;
+			const double swapped = std::max(peak - times[a] + times[b], load[to] + times[a] - times[b]);
+			if (swapped < bestPeak - kEps) {
+				bestPeak = swapped;
+				bestA = a;
+				bestB = b;
+				bestTo = to;
+			}
+		}
+	}
+	if (bestA == times.size())
+		return false;
+	load[busiest] -= times[bestA];
+	load[bestTo] += times[bestA];
+	stationOf[bestA] = bestTo;
+	if (bestB != times.size()) {
+		load[bestTo] -= times[bestB];
+		load[busiest] += times[bestB];
+		stationOf[bestB] = busiest;
+	}
+	return true;
+}
+
+} // anonymous
+
+void ScheduleStations(ScenarioData& data, const StationParams& params)
+{
+	data.stations.clear();
+	if (params.count <= 1)
+		return;
+	const size_t stationCount = static_cast<size_t>(params.count);
+
+	// Estimate before sequencing: every run is a setup
+	std::vector<double> times(data.scenarios.size());
+	for (size_t s = 0; s < data.scenarios.size(); ++s) {
+		const ScenarioInfo& info = data.scenarios[s];
+		times[s] = ScenarioCuts(info) * params.secondsPerCut + info.steps.size() * params.secondsPerSetup;
+	}
+
+	// LPT: longest scenario to the least loaded station
+	std::vector<size_t> order(data.scenarios.size());
+	for (size_t s = 0; s < order.size(); ++s) order[s] = s;
+	std::stable_sort(order.begin(), order.end(), [&times](size_t a, size_t b) { return times[a] > times[b]; });
+	std::vector<double> load(stationCount, 0.0);
+	std::vector<size_t> stationOf(data.scenarios.size(), 0);
+	for (size_t s : order) {
+		const size_t to = static_cast<size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+		stationOf[s] = to;
+		load[to] += times[s];
+	}
+	for (int step = 0; step < kMaxImproveSteps && ImproveOnce(times, stationOf, load); ++step) {
+	}
+
+	// Scenarios keep the global sequence within a station, then the station is sequenced on its own
+	data.stations.resize(stationCount);
+	for (size_t st = 0; st < stationCount; ++st) {
+		ScenarioData station;
+		for (size_t s = 0; s < data.scenarios.size(); ++s) {
+			if (stationOf[s] == st)
+				station.scenarios.push_back(data.scenarios[s]);
+		}
+		SequenceSetups(station);
+
+		StationPlan& plan = data.stations[st];
+		plan.scenarios = std::move(station.scenarios);
+		plan.setListRows = std::move(station.setListRows);
+		plan.setups = station.setupsAfter;
+		for (const ScenarioInfo& info : plan.scenarios) plan.cuts += ScenarioCuts(info);
+		plan.seconds = plan.cuts * params.secondsPerCut + plan.setups * params.secondsPerSetup;
+	}
+}
+
+} // namespace FastProduction
@@ -0,0 +1,253 @@
+#include "FastProduction.hpp"
+#include "CuttingStockProfiles.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+// Order of scenarios and their runs on the saw. Within a width group scenarios form an open path:
+// the distance between two scenarios is one setup if they share no stop length (plus the travel
+// between their closest stops), otherwise zero. The path is built nearest-neighbour and improved
+// with 2-opt; then runs of each scenario are ordered so that the stop set at the end of one scenario
+// is the first stop of the next, and the rest go monotonically in the direction of less travel.
+
+namespace FastProduction {
+
+namespace {
+
+const Int64 kSetupWeight = 1000000000;   // one setup outweighs any travel, mm
+const size_t kMaxTwoOptScenarios = 2000;
+const int kMaxTwoOptSweeps = 50;
+
+struct Node {
+	std::vector<int> stops;   // sorted, distinct
+};
+
+static bool Contains(const std::vector<int>& stops, int stop)
+{
+	return std::binary_search(stops.begin(), stops.end(), stop);
+}
+
+static Int64 Distance(const Node& a, const Node& b)
+{
+	if (a.stops.empty() || b.stops.empty())
+		return 0;
+	Int64 best = -1;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < a.stops.size() && j < b.stops.size()) {
+		const Int64 diff = std::llabs(static_cast<Int64>(a.stops[i]) - b.stops[j]);
+		if (diff == 0)
+			return 0;
+		if (best < 0 || diff < best)
+			best = diff;
+		if (a.stops[i] < b.stops[j]) ++i;
+		else ++j;
+	}
+	return kSetupWeight + best;
+}
+
+// Stops of a step sequence: setups = changes of the stop (the first one counts), travel = sum of moves
+struct SequenceCost {
+	Int32 setups = 0;
+	Int64 travelMm = 0;
+	int lastStop = -1;
+
+	void Visit(int stop)
+	{
+		if (stop == lastStop)
+			return;
+		++setups;
+		if (lastStop >= 0)
+			travelMm += std::llabs(static_cast<Int64>(stop) - lastStop);
+		lastStop = stop;
+	}
+
+	bool operator<(const SequenceCost& o) const
+	{
+		return setups != o.setups ? setups < o.setups : travelMm < o.travelMm;
+	}
+};
+
+// Nearest neighbour from the virtual start (previous group's last stop), then 2-opt; path[0] is the start
+static void OrderGroup(const std::vector<Node>& nodes, std::vector<size_t>& path)
+{
+	const size_t n = nodes.size();
+	std::vector<bool> used(n, false);
+	used[0] = true;
+	path.assign(1, 0);
+	for (size_t step = 1; step < n; ++step) {
+		const Node& cur = nodes[path.back()];
+		size_t next = n;
+		Int64 bestD = 0;
+		for (size_t k = 1; k < n; ++k) {
+			if (used[k]) continue;
+			const Int64 d = Distance(cur, nodes[k]);
+			if (next == n || d < bestD) {
+				next = k;
+				bestD = d;
+			}
+		}
+		used[next] = true;
+		path.push_back(next);
+	}
+	if (n > kMaxTwoOptScenarios)
+		return;
+
+	for (int sweep = 0; sweep < kMaxTwoOptSweeps; ++sweep) {
+		bool improved = false;
+		for (size_t i = 1; i + 1 < n; ++i) {
+			for (size_t j = i + 1; j < n; ++j) {
+				const Int64 before = Distance(nodes[path[i - 1]], nodes[path[i]]) + (j + 1 < n ? Distance(nodes[path[j]], nodes[path[j + 1]]) : 0);
+				const Int64 after = Distance(nodes[path[i - 1]], nodes[path[j]]) + (j + 1 < n ? Distance(nodes[path[i]], nodes[path[j + 1]]) : 0);
+				if (after < before) {
+					std::reverse(path.begin() + static_cast<std::ptrdiff_t>(i), path.begin() + static_cast<std::ptrdiff_t>(j) + 1);
+					improved = true;
+				}
+			}
+		}
+		if (!improved)
+			break;
+	}
+}
+
+// Runs of one scenario: first the stop the saw is already on, last a stop shared with the next scenario,
+// the rest ascending or descending, whichever travels less
+static std::vector<ScenarioStepInfo> OrderSteps(const std::vector<ScenarioStepInfo>& steps, int entryStop, const std::vector<int>* nextStops)
+{
+	std::vector<ScenarioStepInfo> middle = steps;
+	std::vector<ScenarioStepInfo> head;
+	std::vector<ScenarioStepInfo> tail;
+	auto take = [&middle](size_t i, std::vector<ScenarioStepInfo>& to) {
+		to.push_back(middle[i]);
+		middle.erase(middle.begin() + static_cast<std::ptrdiff_t>(i));
+	};
+	for (size_t i = 0; i < middle.size(); ++i) {
+		if (middle[i].stopLength == entryStop) {
+			take(i, head);
+			break;
+		}
+	}
+	if (nextStops) {
+		for (size_t i = 0; i < middle.size(); ++i) {
+			if (Contains(*nextStops, middle[i].stopLength)) {
+				take(i, tail);
+				break;
+			}
+		}
+	}
+
+	auto byStop = [](const ScenarioStepInfo& a, const ScenarioStepInfo& b) { return a.stopLength > b.stopLength; };
+	std::stable_sort(middle.begin(), middle.end(), byStop);
+	auto cost = [&](const std::vector<ScenarioStepInfo>& mid) {
+		SequenceCost c;
+		c.lastStop = entryStop;
+		for (const ScenarioStepInfo& s : head) c.Visit(s.stopLength);
+		for (const ScenarioStepInfo& s : mid) c.Visit(s.stopLength);
+		for (const ScenarioStepInfo& s : tail) c.Visit(s.stopLength);
+		return c;
+	};
+	std::vector<ScenarioStepInfo> ascending(middle.rbegin(), middle.rend());
+	std::stable_sort(ascending.begin(), ascending.end(),
+		[](const ScenarioStepInfo& a, const ScenarioStepInfo& b) { return a.stopLength < b.stopLength; });
+	if (cost(ascending) < cost(middle))
+		middle = ascending;
+
+	std::vector<ScenarioStepInfo> out = head;
+	out.insert(out.end(), middle.begin(), middle.end());
+	out.insert(out.end(), tail.begin(), tail.end());
+	for (size_t r = 0; r < out.size(); ++r)
+		out[r].opOrder = static_cast<int>(r + 1);
+	return out;
+}
+
+static SequenceCost CostOf(const std::vector<ScenarioInfo>& scenarios, int entryStop)
+{
+	SequenceCost c;
+	c.lastStop = entryStop;
+	for (const ScenarioInfo& info : scenarios) {
+		for (const ScenarioStepInfo& s : info.steps) c.Visit(s.stopLength);
+	}
+	return c;
+}
+
+// setListRows in the order of data.scenarios
+static void RebuildSetList(ScenarioData& data)
+{
+	data.setListRows.clear();
+	int seqOrder = 0;
+	for (const ScenarioInfo& info : data.scenarios) {
+		for (const ScenarioStepInfo& s : info.steps) {
+			SetListRow row;
+			row.boardW = info.boardW;
+			row.scenarioId = info.scenarioId;
+			row.stopLength = s.stopLength;
+			row.cutsCount = s.totalCuts;
+			row.boardsCount = info.boardsCount;
+			row.opOrder = s.opOrder;
+			row.seqOrder = ++seqOrder;
+			data.setListRows.push_back(row);
+		}
+	}
+}
+
+} // anonymous
+
+void SequenceSetups(ScenarioData& data, int entryStop)
+{
+	const SequenceCost before = CostOf(data.scenarios, entryStop);
+	data.setupsBefore = data.setupsAfter = before.setups;
+	data.travelBeforeMm = data.travelAfterMm = before.travelMm;
+	if (data.scenarios.size() < 2) {
+		RebuildSetList(data);
+		return;
+	}
+
+	// Width groups in order of first appearance
+	std::vector<std::vector<size_t>> groups;
+	std::unordered_map<Int64, size_t> groupOfWidth;
+	for (size_t s = 0; s < data.scenarios.size(); ++s) {
+		const auto found = groupOfWidth.emplace(CuttingStock::SizeKey(data.scenarios[s].boardW), groups.size());
+		if (found.second)
+			groups.push_back({});
+		groups[found.first->second].push_back(s);
+	}
+
+	std::vector<ScenarioInfo> ordered;
+	ordered.reserve(data.scenarios.size());
+	int lastStop = entryStop;
+	std::vector<Node> nodes;
+	std::vector<size_t> path;
+	for (const std::vector<size_t>& group : groups) {
+		// nodes[0] — the stop the saw is on when the group starts
+		nodes.assign(group.size() + 1, Node());
+		if (lastStop >= 0)
+			nodes[0].stops.push_back(lastStop);
+		for (size_t k = 0; k < group.size(); ++k) {
+			std::vector<int>& stops = nodes[k + 1].stops;
+			for (const ScenarioStepInfo& s : data.scenarios[group[k]].steps) stops.push_back(s.stopLength);
+			std::sort(stops.begin(), stops.end());
+			stops.erase(std::unique(stops.begin(), stops.end()), stops.end());
+		}
+		OrderGroup(nodes, path);
+
+		for (size_t p = 1; p < path.size(); ++p) {
+			ScenarioInfo info = data.scenarios[group[path[p] - 1]];
+			const std::vector<int>* nextStops = (p + 1 < path.size()) ? &nodes[path[p + 1]].stops : nullptr;
+			info.steps = OrderSteps(info.steps, lastStop, nextStops);
+			if (!info.steps.empty())
+				lastStop = info.steps.back().stopLength;
+			ordered.push_back(std::move(info));
+		}
+	}
+
+	// Keep the discovery order unless the new one is strictly better
+	const SequenceCost after = CostOf(ordered, entryStop);
+	if (after < before) {
+		data.scenarios = std::move(ordered);
+		data.setupsAfter = after.setups;
+		data.travelAfterMm = after.travelMm;
+	}
+	RebuildSetList(data);
+}
+
+} // namespace FastProduction
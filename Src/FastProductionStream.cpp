@@ -0,0 +1,39 @@
+#include "FastProduction.hpp"
+#include <cstdlib>
+
+// Scenario data of a large plan group by group: a width group is complete when it is added (the solver
+// emits boards ordered by width), so its scenarios, set list and summary rows are final and can be
+// written out before the next group is expanded.
+
+namespace FastProduction {
+
+ScenarioStream::ScenarioStream(int roundStepMm, bool sortDesc, UInt32 minGroupSize)
+	: roundStepMm(roundStepMm), sortDesc(sortDesc), minGroupSize(minGroupSize)
+{
+}
+
+const ScenarioData& ScenarioStream::AddWidthGroup(const CuttingStock::BoardTable& boards)
+{
+	group = BuildScenarioData(boards, roundStepMm, sortDesc, minGroupSize);
+
+	// Discovery order continues from the previous group as in BuildScenarioData over the whole plan
+	for (const SetListRow& row : group.setListRows) {
+		if (row.stopLength == lastStopBefore)
+			continue;
+		setupsBefore += 1;
+		if (lastStopBefore >= 0)
+			travelBeforeMm += std::llabs(static_cast<Int64>(row.stopLength) - lastStopBefore);
+		lastStopBefore = row.stopLength;
+	}
+
+	SequenceSetups(group, lastStopAfter);
+	setupsAfter += group.setupsAfter;
+	travelAfterMm += group.travelAfterMm;
+	for (SetListRow& row : group.setListRows)
+		row.seqOrder = ++seqOrder;
+	if (!group.setListRows.empty())
+		lastStopAfter = group.setListRows.back().stopLength;
+	return group;
+}
+
+} // namespace FastProduction
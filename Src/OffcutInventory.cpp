@@ -0,0 +1,258 @@
+#include "OffcutInventory.hpp"
+#include "CuttingStockProfiles.hpp"
+#include "SolverAdapter.hpp"
+#include "UserDataFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Формат файла (little-endian, версия 1):
+//   FileHeader
+//   материалы:  materialCount × { UInt32 байт; UTF-8 }
+//   группы:     groupCount × GroupEntry, по (boardW, materialId)
+//   записи:     recordCount × Record, внутри группы — по убыванию длины
+// GroupEntry хранит смещение своих записей, поэтому Load с фильтром читает только их.
+
+namespace OffcutInventory {
+
+namespace {
+
+const char kMagic[4] = { 'A', 'P', 'O', 'F' };
+const UInt32 kVersion = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+	char magic[4];
+	UInt32 version;
+	UInt32 materialCount;
+	UInt32 groupCount;
+	UInt32 recordCount;
+};
+
+struct GroupEntry {
+	double boardW;
+	UInt32 materialId;
+	UInt32 firstRecord;
+	UInt32 recordCount;
+};
+
+struct Record {
+	Int32 lengthMM;
+	Int32 count;
+};
+#pragma pack(pop)
+
+// (boardW в 0.001 мм, материал, длина) -> количество
+using OffcutKey = std::tuple<Int64, std::string, Int32>;
+
+static Int64 WidthKey(double boardW)
+{
+	return CuttingStock::SizeKey(boardW);
+}
+
+struct Directory {
+	FileHeader header;
+	std::vector<std::string> materials;
+	std::vector<GroupEntry> groups;
+	long recordsOffset;
+};
+
+static bool ReadDirectory(FILE* in, Directory& dir)
+{
+	if (!UserDataFile::ReadAll(in, &dir.header, sizeof(dir.header))) return false;
+	if (std::memcmp(dir.header.magic, kMagic, sizeof(kMagic)) != 0 || dir.header.version != kVersion) return false;
+
+	dir.materials.resize(dir.header.materialCount);
+	for (std::string& m : dir.materials) {
+		UInt32 bytes = 0;
+		if (!UserDataFile::ReadAll(in, &bytes, sizeof(bytes))) return false;
+		m.resize(bytes);
+		if (bytes > 0 && !UserDataFile::ReadAll(in, &m[0], bytes)) return false;
+	}
+	dir.groups.resize(dir.header.groupCount);
+	if (!dir.groups.empty() && !UserDataFile::ReadAll(in, dir.groups.data(), dir.groups.size() * sizeof(GroupEntry))) return false;
+	dir.recordsOffset = std::ftell(in);
+	for (const GroupEntry& g : dir.groups) {
+		if (g.materialId >= dir.materials.size() || g.firstRecord + static_cast<UInt64>(g.recordCount) > dir.header.recordCount)
+			return false;
+	}
+	return true;
+}
+
+static bool LoadAll(const GS::UniString& path, std::map<OffcutKey, Int32>& out)
+{
+	FILE* in = UserDataFile::Open(path, "rb");
+	if (!in) return true;   // склада ещё нет
+	Directory dir;
+	std::vector<Record> records;
+	bool ok = ReadDirectory(in, dir);
+	if (ok) {
+		records.resize(dir.header.recordCount);
+		ok = UserDataFile::ReadAll(in, records.data(), records.size() * sizeof(Record));
+	}
+	std::fclose(in);
+	if (!ok) return false;
+
+	for (const GroupEntry& g : dir.groups) {
+		for (UInt32 r = g.firstRecord; r < g.firstRecord + g.recordCount; ++r)
+			out[OffcutKey(WidthKey(g.boardW), dir.materials[g.materialId], records[r].lengthMM)] += records[r].count;
+	}
+	return true;
+}
+
+static bool Save(const GS::UniString& path, const std::map<OffcutKey, Int32>& stock)
+{
+	// Материалы и группы в порядке ключей map: (ширина, материал), длины внутри группы — по убыванию
+	std::vector<std::string> materials;
+	std::map<std::string, UInt32> materialId;
+	std::vector<GroupEntry> groups;
+	std::vector<Record> records;
+	for (auto it = stock.begin(); it != stock.end();) {
+		const Int64 w = std::get<0>(it->first);
+		const std::string& m = std::get<1>(it->first);
+		auto mi = materialId.find(m);
+		if (mi == materialId.end()) {
+			mi = materialId.emplace(m, static_cast<UInt32>(materials.size())).first;
+			materials.push_back(m);
+		}
+		GroupEntry g = { static_cast<double>(w) / 1000.0, mi->second, static_cast<UInt32>(records.size()), 0 };
+		for (; it != stock.end() && std::get<0>(it->first) == w && std::get<1>(it->first) == m; ++it) {
+			if (it->second > 0)
+				records.push_back({ std::get<2>(it->first), it->second });
+		}
+		g.recordCount = static_cast<UInt32>(records.size()) - g.firstRecord;
+		std::reverse(records.begin() + g.firstRecord, records.end());
+		if (g.recordCount > 0)
+			groups.push_back(g);
+	}
+
+	const GS::UniString tmp = path + ".tmp";
+	FILE* out = UserDataFile::Open(tmp, "wb");
+	if (!out) return false;
+	FileHeader header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.materialCount = static_cast<UInt32>(materials.size());
+	header.groupCount = static_cast<UInt32>(groups.size());
+	header.recordCount = static_cast<UInt32>(records.size());
+	bool ok = UserDataFile::WriteAll(out, &header, sizeof(header));
+	for (const std::string& m : materials) {
+		const UInt32 bytes = static_cast<UInt32>(m.size());
+		ok = ok && UserDataFile::WriteAll(out, &bytes, sizeof(bytes)) && UserDataFile::WriteAll(out, m.data(), m.size());
+	}
+	ok = ok && UserDataFile::WriteAll(out, groups.data(), groups.size() * sizeof(GroupEntry));
+	ok = ok && UserDataFile::WriteAll(out, records.data(), records.size() * sizeof(Record));
+	ok = (std::fflush(out) == 0) && ok;
+	ok = (std::fclose(out) == 0) && ok;
+	if (!ok || !UserDataFile::Replace(tmp, path)) {
+		UserDataFile::Remove(tmp);
+		return false;
+	}
+	return true;
+}
+
+} // anonymous
+
+GS::UniString DefaultPath()
+{
+	return UserDataFile::PathFor("offcuts.bin");
+}
+
+bool Load(const GS::UniString& path, const GS::Array<GroupKey>& only, GS::Array<Offcut>& out)
+{
+	out.Clear();
+	FILE* in = UserDataFile::Open(path, "rb");
+	if (!in) return true;   // склада ещё нет
+	Directory dir;
+	bool ok = ReadDirectory(in, dir);
+
+	std::vector<Record> records;
+	for (size_t gi = 0; ok && gi < dir.groups.size(); ++gi) {
+		const GroupEntry& g = dir.groups[gi];
+		if (!only.IsEmpty()) {
+			bool wanted = false;
+			for (UIndex k = 0; k < only.GetSize() && !wanted; ++k)
+				wanted = WidthKey(only[k].boardW) == WidthKey(g.boardW) && SolverAdapter::ToUtf8(only[k].material) == dir.materials[g.materialId];
+			if (!wanted) continue;
+		}
+		records.resize(g.recordCount);
+		ok = std::fseek(in, dir.recordsOffset + static_cast<long>(g.firstRecord * sizeof(Record)), SEEK_SET) == 0 &&
+			UserDataFile::ReadAll(in, records.data(), records.size() * sizeof(Record));
+		if (!ok) break;
+		const GS::UniString material = SolverAdapter::FromUtf8(dir.materials[g.materialId]);
+		for (const Record& r : records) {
+			if (r.count > 0)
+				out.Push({ r.lengthMM, g.boardW, material, r.count });
+		}
+	}
+	std::fclose(in);
+	if (!ok) out.Clear();
+	return ok;
+}
+
+bool Update(const GS::UniString& path, const GS::Array<Offcut>& used, const GS::Array<Offcut>& produced)
+{
+	if (used.IsEmpty() && produced.IsEmpty()) return true;
+	std::map<OffcutKey, Int32> stock;
+	if (!LoadAll(path, stock)) return false;
+	for (UIndex i = 0; i < used.GetSize(); ++i) {
+		const Offcut& o = used[i];
+		auto it = stock.find(OffcutKey(WidthKey(o.boardW), SolverAdapter::ToUtf8(o.material), o.lengthMM));
+		if (it != stock.end())
+			it->second = std::max(0, it->second - o.count);
+	}
+	for (UIndex i = 0; i < produced.GetSize(); ++i) {
+		const Offcut& o = produced[i];
+		stock[OffcutKey(WidthKey(o.boardW), SolverAdapter::ToUtf8(o.material), o.lengthMM)] += o.count;
+	}
+	return Save(path, stock);
+}
+
+void AppendAsStock(const GS::Array<Offcut>& offcuts, std::vector<CuttingStock::StockType>& stockTypes)
+{
+	for (UIndex i = 0; i < offcuts.GetSize(); ++i) {
+		const Offcut& o = offcuts[i];
+		CuttingStock::StockType st;
+		st.length = o.lengthMM;
+		st.cost = o.lengthMM / 1e6;
+		st.available = o.count;
+		st.priority = 0;
+		st.boardW = o.boardW;
+		st.material = SolverAdapter::ToUtf8(o.material);
+		stockTypes.push_back(st);
+	}
+}
+
+void CollectChanges(const CuttingStock::SolverResult& result, const CuttingStock::DemandSet& demand,
+	const std::vector<CuttingStock::StockType>& stockTypes, size_t firstOffcutStock, double usefulMin,
+	GS::Array<Offcut>& outUsed, GS::Array<Offcut>& outProduced)
+{
+	outUsed.Clear();
+	outProduced.Clear();
+	std::map<size_t, Int32> usedByType;
+	std::map<std::tuple<Int64, Int32, Int32>, Int32> produced;   // (ширина, материал, длина)
+	for (size_t b = 0; b < result.boards.size(); ++b) {
+		const CuttingStock::ResultBoard& rb = result.boards[b];
+		if (rb.stockType >= 0 && static_cast<size_t>(rb.stockType) >= firstOffcutStock)
+			usedByType[static_cast<size_t>(rb.stockType)] += 1;
+		if (rb.materialId >= 0 && rb.remainder >= usefulMin && rb.remainder > 0.0)
+			produced[std::make_tuple(WidthKey(rb.boardW), rb.materialId, static_cast<Int32>(std::floor(rb.remainder)))] += 1;
+	}
+	for (const auto& u : usedByType) {
+		if (u.first >= stockTypes.size()) continue;
+		const CuttingStock::StockType& st = stockTypes[u.first];
+		outUsed.Push({ static_cast<Int32>(std::lround(st.length)), st.boardW, SolverAdapter::FromUtf8(st.material), u.second });
+	}
+	for (const auto& p : produced) {
+		const Int32 materialId = std::get<1>(p.first);
+		if (static_cast<size_t>(materialId) >= demand.materials.size()) continue;
+		outProduced.Push({ std::get<2>(p.first), static_cast<double>(std::get<0>(p.first)) / 1000.0, SolverAdapter::FromUtf8(demand.materials[materialId]), p.second });
+	}
+}
+
+} // namespace OffcutInventory
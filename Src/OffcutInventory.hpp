@@ -0,0 +1,48 @@
+#ifndef OFFCUTINVENTORY_HPP
+#define OFFCUTINVENTORY_HPP
+
+#include "GSRoot.hpp"
+#include "UniString.hpp"
+#include "Array.hpp"
+#include "CuttingStockSolver.hpp"
+#include <vector>
+
+// Склад деловых остатков между запусками раскроя.
+// Файл двоичный, с индексом групп (boardW, материал): при загрузке читаются только нужные группы.
+// Запись — во временный файл рядом и замена переименованием, так что файл всегда целый.
+
+namespace OffcutInventory {
+
+struct Offcut {
+	Int32 lengthMM;
+	double boardW;
+	GS::UniString material;
+	Int32 count;
+};
+
+struct GroupKey {
+	double boardW;
+	GS::UniString material;
+};
+
+/** <данные пользователя>/ArchPlanks/offcuts.bin (%APPDATA% на Windows, XDG_DATA_HOME / ~/.local/share иначе). */
+GS::UniString DefaultPath();
+
+/** Остатки групп из only (пусто — все). Нет файла — пустой склад и true; false — файл повреждён. */
+bool Load(const GS::UniString& path, const GS::Array<GroupKey>& only, GS::Array<Offcut>& out);
+
+/** Списать used, добавить produced и атомарно перезаписать файл. */
+bool Update(const GS::UniString& path, const GS::Array<Offcut>& used, const GS::Array<Offcut>& produced);
+
+/** Типы заготовок из остатков: цена ~ длина / 1e6 (на три порядка дешевле новой доски), доступно = count. */
+void AppendAsStock(const GS::Array<Offcut>& offcuts, std::vector<CuttingStock::StockType>& stockTypes);
+
+/** Что из склада израсходовано и какие остатки >= usefulMin получены в плане.
+ *  firstOffcutStock — индекс первого типа-остатка в stockTypes; материалы досок — по demand.materials. */
+void CollectChanges(const CuttingStock::SolverResult& result, const CuttingStock::DemandSet& demand,
+	const std::vector<CuttingStock::StockType>& stockTypes, size_t firstOffcutStock, double usefulMin,
+	GS::Array<Offcut>& outUsed, GS::Array<Offcut>& outProduced);
+
+} // namespace OffcutInventory
+
+#endif
@@ -0,0 +1,15 @@
+#include "SolverAdapter.hpp"
+
+namespace SolverAdapter {
+
+std::string ToUtf8(const GS::UniString& s)
+{
+	return std::string(s.ToCStr(0, MaxUSize, CC_UTF8).Get());
+}
+
+GS::UniString FromUtf8(const std::string& s)
+{
+	return GS::UniString(s.c_str(), CC_UTF8);
+}
+
+} // namespace SolverAdapter
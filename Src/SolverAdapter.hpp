@@ -0,0 +1,21 @@
+#ifndef SOLVERADAPTER_HPP
+#define SOLVERADAPTER_HPP
+
+#include "GSRoot.hpp"
+#include "UniString.hpp"
+#include <string>
+
+// Переход между типами надстройки (GS::UniString) и ядром раскроя (CuttingStock, FastProduction),
+// которое собирается без DevKit и хранит строки в UTF-8.
+
+namespace SolverAdapter {
+
+/** Строка для ядра: UTF-8. */
+std::string ToUtf8(const GS::UniString& s);
+
+/** Строка ядра (UTF-8) для GS API и вывода. */
+GS::UniString FromUtf8(const std::string& s);
+
+} // namespace SolverAdapter
+
+#endif
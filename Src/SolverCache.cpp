@@ -0,0 +1,408 @@
+#include "SolverCache.hpp"
+#include "UserDataFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Формат файла (little-endian):
+//   FileHeader
+//   каталог:  entryCount × DirEntry
+//   записи:   { UInt32 байт ключа; ключ; решение } — по смещениям из каталога
+// Ключ хранится целиком: совпадение hash проверяется сравнением ключей.
+// Материалы в решении записаны именами и при чтении сопоставляются с таблицей текущего DemandSet.
+
+namespace SolverCache {
+
+namespace {
+
+using CuttingStock::CutPattern;
+using CuttingStock::DemandSet;
+using CuttingStock::GroupBound;
+using CuttingStock::PartDemand;
+using CuttingStock::PatternResult;
+using CuttingStock::SolverParams;
+using CuttingStock::StockType;
+
+const char kMagic[4] = { 'A', 'P', 'S', 'C' };
+const UInt32 kFormatVersion = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+	char magic[4];
+	UInt32 formatVersion;
+	UInt32 solverVersion;
+	UInt32 entryCount;
+	UInt64 clock;          // счётчик обращений для LRU
+};
+
+struct DirEntry {
+	UInt64 hash;
+	UInt64 lastUsed;
+	UInt64 offset;
+	UInt32 size;
+};
+#pragma pack(pop)
+
+class Writer {
+public:
+	std::string bytes;
+
+	template <typename T>
+	void Put(T value)
+	{
+		bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void PutString(const std::string& s)
+	{
+		Put(static_cast<UInt32>(s.size()));
+		bytes += s;
+	}
+};
+
+class Reader {
+public:
+	Reader(const char* data, size_t size) : data(data), size(size) {}
+
+	bool ok = true;
+
+	template <typename T>
+	T Get()
+	{
+		T value = T();
+		if (!ok || size - pos < sizeof(T)) {
+			ok = false;
+			return value;
+		}
+		std::memcpy(&value, data + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+
+	std::string GetString()
+	{
+		return GetUtf8(Get<UInt32>());
+	}
+
+	std::string GetUtf8(UInt32 bytes)
+	{
+		if (!ok || size - pos < bytes) {
+			ok = false;
+			return std::string();
+		}
+		const std::string utf8(data + pos, bytes);
+		pos += bytes;
+		return utf8;
+	}
+
+private:
+	const char* data;
+	size_t size;
+	size_t pos = 0;
+};
+
+// Канонический ключ: спрос сливается и сортируется, параметры — все поля по порядку
+static std::string CanonicalKey(const DemandSet& demand, const SolverParams& params, UInt64 context)
+{
+	std::map<std::tuple<Int64, std::string, Int32>, Int64> rows;
+	for (size_t i = 0; i < demand.items.size(); ++i) {
+		const PartDemand& d = demand.items[i];
+		if (d.count <= 0 || d.materialId >= demand.materials.size()) continue;
+		rows[std::make_tuple(static_cast<Int64>(std::llround(d.boardW * 1000.0)), demand.materials[d.materialId], d.lengthMM)] += d.count;
+	}
+
+	Writer w;
+	w.Put(context);
+	w.Put(static_cast<UInt32>(rows.size()));
+	for (const auto& r : rows) {
+		w.Put(std::get<0>(r.first));
+		w.Put(static_cast<UInt32>(std::get<1>(r.first).size()));
+		w.bytes += std::get<1>(r.first);
+		w.Put(std::get<2>(r.first));
+		w.Put(r.second);
+	}
+
+	w.Put(params.maxStockLength);
+	w.Put(static_cast<UInt32>(params.stockTypes.size()));
+	for (size_t t = 0; t < params.stockTypes.size(); ++t) {
+		const StockType& st = params.stockTypes[t];
+		w.Put(st.length);
+		w.Put(st.cost);
+		w.Put(st.available);
+		w.Put(st.priority);
+		w.Put(st.boardW);
+		w.PutString(st.material);
+	}
+	w.Put(params.slit);
+	w.Put(params.trimLoss);
+	w.Put(params.usefulMin);
+	w.Put(params.wasteMax);
+	w.Put(static_cast<UInt8>(params.strictAB));
+	w.Put(static_cast<Int32>(params.maxImproveIter));
+	w.Put(static_cast<Int32>(params.improveTimeMs));
+	w.Put(static_cast<Int32>(params.mode));
+	w.Put(static_cast<UInt8>(params.groupByMaterial));
+	w.Put(params.threadCount);
+	w.Put(params.exactNodeLimit);
+	w.Put(static_cast<Int32>(params.exactTimeMs));
+	w.Put(static_cast<Int32>(params.patternReduceIter));
+	w.Put(params.patternWasteWeight);
+	w.Put(params.svcPasses);
+	return w.bytes;
+}
+
+const UInt32 kNoMaterial = 0xFFFFFFFF;
+
+static void PutMaterial(Writer& w, Int32 materialId, const DemandSet& demand)
+{
+	if (materialId < 0 || static_cast<size_t>(materialId) >= demand.materials.size())
+		w.Put(kNoMaterial);
+	else
+		w.PutString(demand.materials[materialId]);
+}
+
+static bool GetMaterial(Reader& r, const DemandSet& demand, Int32& materialId)
+{
+	const UInt32 bytes = r.Get<UInt32>();
+	materialId = -1;
+	if (bytes == kNoMaterial) return r.ok;
+	const std::string name = r.GetUtf8(bytes);
+	for (size_t m = 0; m < demand.materials.size() && r.ok; ++m) {
+		if (demand.materials[m] == name) {
+			materialId = static_cast<Int32>(m);
+			return true;
+		}
+	}
+	return false;
+}
+
+static std::string EncodeResult(const PatternResult& result, const DemandSet& demand)
+{
+	Writer w;
+	w.Put(static_cast<UInt32>(result.patterns.size()));
+	for (size_t p = 0; p < result.patterns.size(); ++p) {
+		const CutPattern& cp = result.patterns[p];
+		w.Put(cp.remainder);
+		w.Put(cp.boardW);
+		w.Put(cp.stockType);
+		w.Put(cp.stockLength);
+		PutMaterial(w, cp.materialId, demand);
+		w.Put(cp.count);
+		w.Put(static_cast<UInt32>(cp.cutsMM.size()));
+		for (size_t c = 0; c < cp.cutsMM.size(); ++c) w.Put(cp.cutsMM[c]);
+	}
+	w.Put(static_cast<UInt32>(result.remaining.size()));
+	for (size_t i = 0; i < result.remaining.size(); ++i) {
+		const PartDemand& d = result.remaining[i];
+		w.Put(d.lengthMM);
+		PutMaterial(w, static_cast<Int32>(d.materialId), demand);
+		w.Put(d.boardW);
+		w.Put(d.count);
+	}
+	w.Put(static_cast<UInt32>(result.bounds.size()));
+	for (size_t i = 0; i < result.bounds.size(); ++i) {
+		const GroupBound& gb = result.bounds[i];
+		w.Put(gb.boardW);
+		w.PutString(gb.material);
+		w.Put(gb.l1);
+		w.Put(gb.l2);
+		w.Put(gb.boards);
+		w.Put(gb.gap);
+		w.Put(static_cast<UInt8>(gb.optimal));
+	}
+	return w.bytes;
+}
+
+static bool DecodeResult(Reader& r, const DemandSet& demand, PatternResult& out)
+{
+	out = PatternResult();
+	const UInt32 patterns = r.Get<UInt32>();
+	for (UInt32 p = 0; p < patterns && r.ok; ++p) {
+		CutPattern cp;
+		cp.remainder = r.Get<double>();
+		cp.boardW = r.Get<double>();
+		cp.stockType = r.Get<Int32>();
+		cp.stockLength = r.Get<double>();
+		if (!GetMaterial(r, demand, cp.materialId)) return false;
+		cp.count = r.Get<Int32>();
+		const UInt32 cuts = r.Get<UInt32>();
+		for (UInt32 c = 0; c < cuts && r.ok; ++c) cp.cutsMM.push_back(r.Get<Int32>());
+		out.patterns.push_back(cp);
+	}
+	const UInt32 remaining = r.Get<UInt32>();
+	for (UInt32 i = 0; i < remaining && r.ok; ++i) {
+		PartDemand d;
+		d.lengthMM = r.Get<Int32>();
+		Int32 materialId = -1;
+		if (!GetMaterial(r, demand, materialId) || materialId < 0) return false;
+		d.materialId = static_cast<UInt32>(materialId);
+		d.boardW = r.Get<double>();
+		d.count = r.Get<Int32>();
+		out.remaining.push_back(d);
+	}
+	const UInt32 bounds = r.Get<UInt32>();
+	for (UInt32 i = 0; i < bounds && r.ok; ++i) {
+		GroupBound gb;
+		gb.boardW = r.Get<double>();
+		gb.material = r.GetString();
+		gb.l1 = r.Get<Int32>();
+		gb.l2 = r.Get<Int32>();
+		gb.boards = r.Get<Int32>();
+		gb.gap = r.Get<double>();
+		gb.optimal = r.Get<UInt8>() != 0;
+		out.bounds.push_back(gb);
+	}
+	return r.ok;
+}
+
+struct Entry {
+	UInt64 hash;
+	UInt64 lastUsed;
+	std::string blob;
+};
+
+static bool ReadHeader(FILE* in, FileHeader& header, std::vector<DirEntry>& dir)
+{
+	if (!UserDataFile::ReadAll(in, &header, sizeof(header))) return false;
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion ||
+		header.solverVersion != CuttingStock::kSolverVersion)
+		return false;
+	dir.resize(header.entryCount);
+	return UserDataFile::ReadAll(in, dir.data(), dir.size() * sizeof(DirEntry));
+}
+
+static bool ReadBlob(FILE* in, const DirEntry& e, std::string& blob)
+{
+	blob.resize(e.size);
+	return std::fseek(in, static_cast<long>(e.offset), SEEK_SET) == 0 && UserDataFile::ReadAll(in, &blob[0], blob.size());
+}
+
+// Ключ в начале записи совпадает с key
+static bool BlobHasKey(const std::string& blob, const std::string& key)
+{
+	UInt32 n = 0;
+	if (blob.size() < sizeof(n)) return false;
+	std::memcpy(&n, blob.data(), sizeof(n));
+	return n == key.size() && blob.size() - sizeof(n) >= n && blob.compare(sizeof(n), n, key) == 0;
+}
+
+} // anonymous
+
+GS::UniString DefaultPath()
+{
+	return UserDataFile::PathFor("solver-cache.bin");
+}
+
+bool Lookup(const GS::UniString& path, const DemandSet& demand, const SolverParams& params, UInt64 context, PatternResult& out)
+{
+	const std::string key = CanonicalKey(demand, params, context);
+	const UInt64 hash = UserDataFile::Hash(key.data(), key.size());
+
+	FILE* in = UserDataFile::Open(path, "rb");
+	if (!in) return false;
+	FileHeader header;
+	std::vector<DirEntry> dir;
+	bool found = false;
+	size_t index = 0;
+	if (ReadHeader(in, header, dir)) {
+		std::string blob;
+		for (size_t i = 0; i < dir.size() && !found; ++i) {
+			if (dir[i].hash != hash || !ReadBlob(in, dir[i], blob) || !BlobHasKey(blob, key)) continue;
+			const size_t keyBytes = sizeof(UInt32) + key.size();
+			Reader r(blob.data() + keyBytes, blob.size() - keyBytes);
+			found = DecodeResult(r, demand, out);
+			index = i;
+		}
+	}
+	std::fclose(in);
+	if (!found) return false;
+
+	// Отметить использование на месте: меняются только счётчик и поле записи в каталоге
+	if (FILE* io = UserDataFile::Open(path, "r+b")) {
+		header.clock += 1;
+		dir[index].lastUsed = header.clock;
+		if (UserDataFile::WriteAll(io, &header, sizeof(header)) &&
+			std::fseek(io, static_cast<long>(sizeof(header) + index * sizeof(DirEntry)), SEEK_SET) == 0)
+			UserDataFile::WriteAll(io, &dir[index], sizeof(DirEntry));
+		std::fclose(io);
+	}
+	return true;
+}
+
+bool Store(const GS::UniString& path, const DemandSet& demand, const SolverParams& params, UInt64 context,
+	const PatternResult& result, UInt64 maxBytes)
+{
+	const std::string key = CanonicalKey(demand, params, context);
+	const UInt64 hash = UserDataFile::Hash(key.data(), key.size());
+
+	// Прежние записи (если файл нашей версии), кроме записи с тем же ключом
+	std::vector<Entry> entries;
+	UInt64 clock = 0;
+	if (FILE* in = UserDataFile::Open(path, "rb")) {
+		FileHeader header;
+		std::vector<DirEntry> dir;
+		if (ReadHeader(in, header, dir)) {
+			clock = header.clock;
+			for (const DirEntry& e : dir) {
+				Entry entry = { e.hash, e.lastUsed, std::string() };
+				if (!ReadBlob(in, e, entry.blob)) {
+					entries.clear();
+					break;
+				}
+				if (e.hash == hash && BlobHasKey(entry.blob, key)) continue;
+				entries.push_back(entry);
+			}
+		}
+		std::fclose(in);
+	}
+
+	Writer blob;
+	blob.Put(static_cast<UInt32>(key.size()));
+	blob.bytes += key;
+	blob.bytes += EncodeResult(result, demand);
+	entries.push_back({ hash, ++clock, blob.bytes });
+
+	// LRU: давно не использованные уходят первыми; новая запись остаётся в любом случае
+	std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed > b.lastUsed; });
+	UInt64 total = sizeof(FileHeader);
+	size_t keep = 0;
+	for (; keep < entries.size(); ++keep) {
+		const UInt64 bytes = sizeof(DirEntry) + entries[keep].blob.size();
+		if (keep > 0 && total + bytes > maxBytes) break;
+		total += bytes;
+	}
+	entries.resize(keep);
+
+	FileHeader header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.formatVersion = kFormatVersion;
+	header.solverVersion = CuttingStock::kSolverVersion;
+	header.entryCount = static_cast<UInt32>(entries.size());
+	header.clock = clock;
+	std::vector<DirEntry> dir;
+	UInt64 offset = sizeof(FileHeader) + entries.size() * sizeof(DirEntry);
+	for (const Entry& e : entries) {
+		dir.push_back({ e.hash, e.lastUsed, offset, static_cast<UInt32>(e.blob.size()) });
+		offset += e.blob.size();
+	}
+
+	const GS::UniString tmp = path + ".tmp";
+	FILE* out = UserDataFile::Open(tmp, "wb");
+	if (!out) return false;
+	bool ok = UserDataFile::WriteAll(out, &header, sizeof(header)) &&
+		UserDataFile::WriteAll(out, dir.data(), dir.size() * sizeof(DirEntry));
+	for (const Entry& e : entries) ok = ok && UserDataFile::WriteAll(out, e.blob.data(), e.blob.size());
+	ok = (std::fflush(out) == 0) && ok;
+	ok = (std::fclose(out) == 0) && ok;
+	if (!ok || !UserDataFile::Replace(tmp, path)) {
+		UserDataFile::Remove(tmp);
+		return false;
+	}
+	return true;
+}
+
+} // namespace SolverCache
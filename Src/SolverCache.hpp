@@ -0,0 +1,30 @@
+#ifndef SOLVERCACHE_HPP
+#define SOLVERCACHE_HPP
+
+#include "GSRoot.hpp"
+#include "UniString.hpp"
+#include "CuttingStockSolver.hpp"
+
+// Кэш решений на диске. Ключ — канонический вход: агрегированный спрос по (ширина, материал, длина),
+// все поля SolverParams и внешний контекст (состояние, от которого ещё зависит план, — например, склад остатков).
+// Один файл: каталог записей (hash ключа, момент последнего использования) и сами записи; при превышении
+// лимита вытесняются давно не использованные. Файл другой версии решателя (kSolverVersion) не читается.
+
+namespace SolverCache {
+
+const UInt64 kDefaultMaxBytes = 16 * 1024 * 1024;
+
+/** <данные пользователя>/ArchPlanks/solver-cache.bin */
+GS::UniString DefaultPath();
+
+/** Решение для (demand, params, context), если оно есть в кэше; materialId — по таблице demand. */
+bool Lookup(const GS::UniString& path, const CuttingStock::DemandSet& demand, const CuttingStock::SolverParams& params,
+	UInt64 context, CuttingStock::PatternResult& out);
+
+/** Записать решение; файл перезаписывается атомарно, лишнее сверх maxBytes вытесняется. */
+bool Store(const GS::UniString& path, const CuttingStock::DemandSet& demand, const CuttingStock::SolverParams& params,
+	UInt64 context, const CuttingStock::PatternResult& result, UInt64 maxBytes = kDefaultMaxBytes);
+
+} // namespace SolverCache
+
+#endif
@@ -0,0 +1,109 @@
+#include "UserDataFile.hpp"
+#include <cstdlib>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace UserDataFile {
+
+static void MakeDirectory(const GS::UniString& path)
+{
+#ifdef _WIN32
+	CreateDirectoryW(path.ToUStr().Get(), NULL);
+#else
+	mkdir(path.ToCStr(0, MaxUSize, CC_UTF8).Get(), 0755);
+#endif
+}
+
+GS::UniString PathFor(const char* fileName)
+{
+	GS::UniString base;
+#ifdef _WIN32
+	if (const wchar_t* appData = _wgetenv(L"APPDATA"))
+		base = GS::UniString(appData);
+	if (base.IsEmpty())
+		base = ".";
+	base += "\\ArchPlanks";
+	MakeDirectory(base);
+	return base + "\\" + fileName;
+#else
+	if (const char* xdg = std::getenv("XDG_DATA_HOME"))
+		base = GS::UniString(xdg, CC_UTF8);
+	else if (const char* home = std::getenv("HOME"))
+		base = GS::UniString(home, CC_UTF8) + "/.local/share";
+	if (base.IsEmpty())
+		base = ".";
+	base += "/ArchPlanks";
+	MakeDirectory(base);
+	return base + "/" + fileName;
+#endif
+}
+
+FILE* Open(const GS::UniString& path, const char* mode)
+{
+#ifdef _WIN32
+	wchar_t wmode[8] = {};
+	for (size_t i = 0; i + 1 < sizeof(wmode) / sizeof(wmode[0]) && mode[i] != '\0'; ++i)
+		wmode[i] = static_cast<wchar_t>(mode[i]);
+	return _wfopen(path.ToUStr().Get(), wmode);
+#else
+	return std::fopen(path.ToCStr(0, MaxUSize, CC_UTF8).Get(), mode);
+#endif
+}
+
+bool Replace(const GS::UniString& tmp, const GS::UniString& target)
+{
+#ifdef _WIN32
+	return MoveFileExW(tmp.ToUStr().Get(), target.ToUStr().Get(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(tmp.ToCStr(0, MaxUSize, CC_UTF8).Get(), target.ToCStr(0, MaxUSize, CC_UTF8).Get()) == 0;
+#endif
+}
+
+void Remove(const GS::UniString& path)
+{
+#ifdef _WIN32
+	DeleteFileW(path.ToUStr().Get());
+#else
+	std::remove(path.ToCStr(0, MaxUSize, CC_UTF8).Get());
+#endif
+}
+
+bool ReadAll(FILE* fp, void* dst, size_t bytes)
+{
+	return bytes == 0 || std::fread(dst, 1, bytes, fp) == bytes;
+}
+
+bool WriteAll(FILE* fp, const void* src, size_t bytes)
+{
+	return bytes == 0 || std::fwrite(src, 1, bytes, fp) == bytes;
+}
+
+UInt64 Hash(const void* data, size_t bytes, UInt64 seed)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	UInt64 h = seed;
+	for (size_t i = 0; i < bytes; ++i) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+UInt64 ContentHash(const GS::UniString& path)
+{
+	FILE* fp = Open(path, "rb");
+	if (!fp) return 0;
+	UInt64 h = Hash(nullptr, 0);
+	std::vector<unsigned char> buf(64 * 1024);
+	size_t n;
+	while ((n = std::fread(buf.data(), 1, buf.size(), fp)) > 0)
+		h = Hash(buf.data(), n, h);
+	std::fclose(fp);
+	return h;
+}
+
+} // namespace UserDataFile
@@ -0,0 +1,35 @@
+#ifndef USERDATAFILE_HPP
+#define USERDATAFILE_HPP
+
+#include "GSRoot.hpp"
+#include "UniString.hpp"
+#include <cstdio>
+
+// Файлы плагина в каталоге данных пользователя (склад остатков, кэш решений).
+// Пути — GS::UniString; на Windows открываются через широкие функции, иначе — как UTF-8.
+
+namespace UserDataFile {
+
+/** <данные пользователя>/ArchPlanks/fileName (%APPDATA% на Windows, XDG_DATA_HOME / ~/.local/share иначе); каталог создаётся. */
+GS::UniString PathFor(const char* fileName);
+
+/** fopen в двоичном режиме: "rb", "wb" или "r+b". */
+FILE* Open(const GS::UniString& path, const char* mode);
+
+/** Заменить target файлом tmp одной операцией (на месте target никогда не бывает недописанного файла). */
+bool Replace(const GS::UniString& tmp, const GS::UniString& target);
+
+void Remove(const GS::UniString& path);
+
+bool ReadAll(FILE* fp, void* dst, size_t bytes);
+bool WriteAll(FILE* fp, const void* src, size_t bytes);
+
+/** FNV-1a 64 бита. */
+UInt64 Hash(const void* data, size_t bytes, UInt64 seed = 14695981039346656037ULL);
+
+/** Hash содержимого файла; 0 — файла нет. */
+UInt64 ContentHash(const GS::UniString& path);
+
+} // namespace UserDataFile
+
+#endif
@@ -0,0 +1,612 @@
+// Бенчмарк решателя раскроя без Archicad: наборы задач bin packing (Falkenauer, Scholl, трудные)
+// и синтетические задания каркаса с пропилом. На каждую задачу — строка CSV (или JSON) в stdout:
+// число досок против известного оптимума / нижней оценки, отход, время. Сводка — в stderr.
+// Задачи генерируются детерминированно (mt19937 с фиксированным зерном), так что прогоны сравнимы
+// между версиями; файлы BPPLIB (n, C, затем n весов) подаются через --bpp.
+// --dynamic N вместо этого правит план каждой задачи через DynamicPlan (N случайных вставок и удалений
+// при strictAB) и проверяет его после каждой правки.
+
+#include "CuttingStockDynamic.hpp"
+#include "CuttingStockSolver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using CuttingStock::Int32;
+using CuttingStock::UInt32;
+using CuttingStock::Int64;
+
+struct PartGroup {
+	Int32 length;
+	Int32 count;
+	const char* material;
+	double boardW;
+};
+
+struct Instance {
+	std::string set;
+	std::string name;
+	Int32 capacity;              // длина заготовки
+	double slit;
+	double usefulMin;
+	double wasteMax;
+	std::vector<PartGroup> parts;
+	Int32 optimum;               // известный оптимум; -1 — неизвестен
+};
+
+struct Options {
+	std::vector<std::string> sets;
+	CuttingStock::SolverMode mode = CuttingStock::SolverMode::Greedy;
+	Int32 threads = 0;
+	int timeLimitMs = 0;
+	bool json = false;
+	bool quick = false;
+	Int32 edits = 0;             // --dynamic: правок DynamicPlan на задачу; 0 — обычное решение
+	std::vector<std::pair<std::string, Int32>> files;   // (путь, оптимум или -1)
+};
+
+struct Outcome {
+	Int32 items;
+	Int32 lowerBound;
+	Int32 boards;
+	Int32 patterns;
+	Int32 unplaced;
+	double wastePct;
+	double timeMs;
+	bool valid;
+	bool interrupted;
+};
+
+struct DynamicOutcome {
+	Int32 items;          // спрос после правок
+	Int32 edits;
+	Int32 boards;
+	Int32 unplaced;
+	double timeMs;        // все правки
+	double worstMs;       // самая долгая правка
+	bool valid;
+};
+
+// -------------------- генераторы --------------------
+
+class Random {
+public:
+	explicit Random(UInt32 seed) : engine(seed) {}
+
+	// Равномерно в [lo, hi]; свой вывод вместо uniform_int_distribution — одинаковые задачи на всех STL.
+	Int32 Uniform(Int32 lo, Int32 hi)
+	{
+		return lo + static_cast<Int32>(engine() % static_cast<UInt32>(hi - lo + 1));
+	}
+
+private:
+	std::mt19937 engine;
+};
+
+static std::string Name(const char* format, Int32 a, Int32 b, Int32 c = 0)
+{
+	char buf[64];
+	std::snprintf(buf, sizeof(buf), format, a, b, c);
+	return buf;
+}
+
+static void AddItems(Instance& inst, const std::vector<Int32>& weights)
+{
+	std::map<Int32, Int32> counts;
+	for (Int32 w : weights)
+		counts[w] += 1;
+	for (auto it = counts.rbegin(); it != counts.rend(); ++it)
+		inst.parts.push_back({ it->first, it->second, "", 0.0 });
+}
+
+static Instance BinPacking(const char* set, const std::string& name, Int32 capacity, const std::vector<Int32>& weights, Int32 optimum)
+{
+	Instance inst;
+	inst.set = set;
+	inst.name = name;
+	inst.capacity = capacity;
+	inst.slit = 0.0;
+	inst.usefulMin = 0.0;
+	inst.wasteMax = 0.0;
+	inst.optimum = optimum;
+	AddItems(inst, weights);
+	return inst;
+}
+
+// Falkenauer U: C = 150, веса равномерно в [20, 100].
+static void FalkenauerUniform(std::vector<Instance>& out, bool quick)
+{
+	const Int32 sizes[] = { 120, 250, 500, 1000 };
+	for (Int32 n : sizes) {
+		if (quick && n > 250) break;
+		for (Int32 k = 0; k < (quick ? 2 : 5); ++k) {
+			Random rnd(1000u + static_cast<UInt32>(n * 10 + k));
+			std::vector<Int32> w(n);
+			for (Int32& x : w)
+				x = rnd.Uniform(20, 100);
+			out.push_back(BinPacking("falkenauer_u", Name("u%d_%d", n, k), 150, w, -1));
+		}
+	}
+}
+
+// Falkenauer T: C = 1000, тройки весов в (250, 500) с суммой ровно C — оптимум n / 3.
+static void FalkenauerTriplets(std::vector<Instance>& out, bool quick)
+{
+	const Int32 sizes[] = { 60, 120, 249, 501 };
+	for (Int32 n : sizes) {
+		if (quick && n > 120) break;
+		for (Int32 k = 0; k < (quick ? 2 : 5); ++k) {
+			Random rnd(2000u + static_cast<UInt32>(n * 10 + k));
+			std::vector<Int32> w;
+			for (Int32 t = 0; t < n / 3; ++t) {
+				const Int32 a = rnd.Uniform(380, 490);
+				const Int32 b = rnd.Uniform(251, 1000 - a - 251);
+				w.push_back(a);
+				w.push_back(b);
+				w.push_back(1000 - a - b);
+			}
+			out.push_back(BinPacking("falkenauer_t", Name("t%d_%d", n, k), 1000, w, n / 3));
+		}
+	}
+}
+
+// Scholl bin1: n ∈ {50, 100, 200, 500}, C ∈ {100, 120, 150}, веса в [1|20|30, 100].
+static void SchollBin1(std::vector<Instance>& out, bool quick)
+{
+	const Int32 sizes[] = { 50, 100, 200, 500 };
+	const Int32 caps[] = { 100, 120, 150 };
+	const Int32 lows[] = { 1, 20, 30 };
+	for (Int32 n : sizes) {
+		if (quick && n > 100) break;
+		for (Int32 c : caps) {
+			for (Int32 lo : lows) {
+				Random rnd(3000u + static_cast<UInt32>(n * 1000 + c * 10 + lo));
+				std::vector<Int32> w(n);
+				for (Int32& x : w)
+					x = rnd.Uniform(lo, 100);
+				out.push_back(BinPacking("scholl_1", Name("n%dc%dw%d", n, c, lo), c, w, -1));
+			}
+		}
+	}
+}
+
+// Scholl bin2: C = 1000, средний вес C/3 … C/9, разброс ±20 / 50 / 90 %.
+static void SchollBin2(std::vector<Instance>& out, bool quick)
+{
+	const Int32 sizes[] = { 50, 100, 200, 500 };
+	const Int32 divisors[] = { 3, 5, 7, 9 };
+	const Int32 spreads[] = { 20, 50, 90 };
+	for (Int32 n : sizes) {
+		if (quick && n > 100) break;
+		for (Int32 d : divisors) {
+			for (Int32 s : spreads) {
+				Random rnd(4000u + static_cast<UInt32>(n * 1000 + d * 100 + s));
+				const Int32 mean = 1000 / d;
+				const Int32 delta = mean * s / 100;
+				std::vector<Int32> w(n);
+				for (Int32& x : w)
+					x = rnd.Uniform(std::max(1, mean - delta), mean + delta);
+				out.push_back(BinPacking("scholl_2", Name("n%dw%db%d", n, d, s), 1000, w, -1));
+			}
+		}
+	}
+}
+
+// Трудные задачи в духе Scholl bin3 / Hard28: C = 100000, n = 200, веса в [20000, 35000] —
+// 3–5 деталей на доску, L2 почти всегда равна оптимуму, а BFD ошибается на доску-две.
+// Сами Hard28 (Schoenfield) подаются файлами через --bpp.
+static void Hard(std::vector<Instance>& out, bool quick)
+{
+	for (Int32 k = 0; k < (quick ? 2 : 10); ++k) {
+		Random rnd(5000u + static_cast<UInt32>(k));
+		std::vector<Int32> w(200);
+		for (Int32& x : w)
+			x = rnd.Uniform(20000, 35000);
+		out.push_back(BinPacking("hard", Name("h%d_%d", 200, k), 100000, w, -1));
+	}
+}
+
+// Каркас: стойки, обвязки, ригели и перемычки трёх сечений; заготовка 6000, пропил 4 мм,
+// A/B как в надстройке. Оптимум неизвестен — сравнение с нижней оценкой решателя.
+static void Framing(std::vector<Instance>& out, bool quick)
+{
+	struct Section {
+		const char* material;
+		double boardW;
+	};
+	const Section sections[] = { { "C24 45x145", 145.0 }, { "C24 45x195", 195.0 }, { "C24 45x95", 95.0 } };
+	const Int32 walls[] = { 6, 20, 60 };
+	for (Int32 wallCount : walls) {
+		if (quick && wallCount > 20) break;
+		for (Int32 k = 0; k < (quick ? 1 : 3); ++k) {
+			Random rnd(6000u + static_cast<UInt32>(wallCount * 10 + k));
+			Instance inst;
+			inst.set = "framing";
+			inst.name = Name("walls%d_%d", wallCount, k);
+			inst.capacity = 6000;
+			inst.slit = 4.0;
+			inst.usefulMin = 300.0;
+			inst.wasteMax = 50.0;
+			inst.optimum = -1;
+			std::map<std::pair<Int32, Int32>, Int32> counts;   // (сечение, длина) -> количество
+			for (Int32 wi = 0; wi < wallCount; ++wi) {
+				const Int32 s = rnd.Uniform(0, 2);
+				const Int32 wallLen = rnd.Uniform(1800, 11000);
+				const Int32 height = rnd.Uniform(2500, 2900);
+				// обвязки: верх и низ, длинные стены — из двух частей
+				const Int32 plateParts = (wallLen + 5399) / 5400;
+				counts[{ s, wallLen / plateParts }] += 2 * plateParts;
+				// стойки с шагом 600 и по краям
+				counts[{ s, height - 90 }] += wallLen / 600 + 2;
+				// проёмы: перемычка, подоконный ригель, укороченные стойки
+				const Int32 openings = rnd.Uniform(0, std::max(0, wallLen / 2500));
+				for (Int32 o = 0; o < openings; ++o) {
+					const Int32 w = rnd.Uniform(6, 18) * 100;
+					counts[{ s, w + 90 }] += 2;
+					counts[{ s, rnd.Uniform(800, 1000) }] += w / 600 + 1;
+					counts[{ s, rnd.Uniform(300, 600) }] += w / 600 + 1;
+				}
+				// ригели между стойками
+				counts[{ s, 555 }] += wallLen / 600;
+			}
+			for (const auto& c : counts)
+				inst.parts.push_back({ c.first.second, c.second, sections[c.first.first].material, sections[c.first.first].boardW });
+			out.push_back(inst);
+		}
+	}
+}
+
+// Файл BPPLIB: n, C, затем n весов (целые, через пробел или перевод строки).
+static bool LoadBppFile(const std::string& path, Int32 optimum, Instance& out)
+{
+	std::ifstream in(path);
+	long long n = 0;
+	long long capacity = 0;
+	if (!(in >> n >> capacity) || n <= 0 || capacity <= 0 || capacity > 100000000) return false;
+	std::vector<Int32> w;
+	for (long long i = 0; i < n; ++i) {
+		long long x = 0;
+		if (!(in >> x) || x <= 0 || x > capacity) return false;
+		w.push_back(static_cast<Int32>(x));
+	}
+	std::string name = path;
+	const size_t slash = name.find_last_of("/\\");
+	if (slash != std::string::npos)
+		name = name.substr(slash + 1);
+	out = BinPacking("file", name, static_cast<Int32>(capacity), w, optimum);
+	return true;
+}
+
+// -------------------- прогон --------------------
+
+static CuttingStock::SolverParams MakeParams(const Instance& inst, const Options& opt)
+{
+	CuttingStock::SolverParams p = {};
+	p.maxStockLength = inst.capacity;
+	p.slit = inst.slit;
+	p.trimLoss = 0.0;
+	p.usefulMin = inst.usefulMin;
+	p.wasteMax = inst.wasteMax;
+	p.strictAB = false;
+	// как DefaultSolverParams надстройки
+	p.maxImproveIter = 2000;
+	p.improveTimeMs = 300;
+	p.mode = opt.mode;
+	p.groupByMaterial = true;
+	p.threadCount = opt.threads;
+	p.exactNodeLimit = 200000;
+	p.exactTimeMs = 200;
+	p.patternReduceIter = 200000;
+	p.patternWasteWeight = 0.5;
+	p.svcPasses = 10;
+	return p;
+}
+
+// Каждая доска вмещает свои детали с пропилом, и размещённые + неразмещённые детали совпадают со спросом.
+static bool CheckPlan(const CuttingStock::PatternResult& result, const CuttingStock::DemandSet& demand, const CuttingStock::SolverParams& params)
+{
+	std::map<std::pair<UInt32, Int32>, Int64> left;
+	for (size_t i = 0; i < demand.items.size(); ++i)
+		left[{ demand.items[i].materialId, demand.items[i].lengthMM }] += demand.items[i].count;
+	for (size_t i = 0; i < result.remaining.size(); ++i)
+		left[{ result.remaining[i].materialId, result.remaining[i].lengthMM }] -= result.remaining[i].count;
+	for (size_t i = 0; i < result.patterns.size(); ++i) {
+		const CuttingStock::CutPattern& pat = result.patterns[i];
+		if (pat.count <= 0) return false;
+		const Int64 capacity = std::lround(pat.stockLength - params.trimLoss + params.slit);
+		Int64 used = 0;
+		for (size_t c = 0; c < pat.cutsMM.size(); ++c) {
+			used += pat.cutsMM[c] + std::lround(params.slit);
+			left[{ static_cast<UInt32>(pat.materialId < 0 ? 0 : pat.materialId), pat.cutsMM[c] }] -= pat.count;
+		}
+		if (used > capacity) return false;
+	}
+	for (const auto& l : left) {
+		if (l.second != 0) return false;
+	}
+	return true;
+}
+
+static Outcome Run(const Instance& inst, const Options& opt)
+{
+	CuttingStock::DemandSet demand;
+	Outcome r = {};
+	for (const PartGroup& g : inst.parts) {
+		CuttingStock::AddDemand(demand, g.length, g.material, g.boardW, g.count);
+		r.items += g.count;
+	}
+	const CuttingStock::SolverParams params = MakeParams(inst, opt);
+	CuttingStock::SolveControl control;
+	control.timeLimitMs = opt.timeLimitMs;
+
+	const auto start = std::chrono::steady_clock::now();
+	const CuttingStock::PatternResult result = CuttingStock::Solve(demand, params, control);
+	r.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	double stock = 0.0;
+	double parts = 0.0;
+	for (size_t i = 0; i < result.patterns.size(); ++i) {
+		const CuttingStock::CutPattern& pat = result.patterns[i];
+		r.boards += pat.count;
+		stock += pat.stockLength * pat.count;
+		for (size_t c = 0; c < pat.cutsMM.size(); ++c)
+			parts += static_cast<double>(pat.cutsMM[c]) * pat.count;
+	}
+	for (size_t i = 0; i < result.remaining.size(); ++i)
+		r.unplaced += result.remaining[i].count;
+	for (size_t i = 0; i < result.bounds.size(); ++i)
+		r.lowerBound += result.bounds[i].l2;
+	r.patterns = static_cast<Int32>(result.patterns.size());
+	r.wastePct = stock > 0.0 ? 100.0 * (stock - parts) / stock : 0.0;
+	r.valid = CheckPlan(result, demand, params);
+	r.interrupted = result.interrupted;
+	return r;
+}
+
+// Детали досок и неразмещённые совпадают со спросом, каждая доска вмещает свои детали, заготовок не больше
+// available, а при strictAB остаток доски с несколькими деталями — не между wasteMax и usefulMin.
+static bool CheckDynamic(const CuttingStock::DynamicPlan& plan, const CuttingStock::SolverParams& params)
+{
+	const CuttingStock::DemandSet& demand = plan.Demand();
+	std::map<std::pair<UInt32, Int32>, Int64> left;
+	for (size_t i = 0; i < demand.items.size(); ++i)
+		left[{ demand.items[i].materialId, demand.items[i].lengthMM }] += demand.items[i].count;
+	const CuttingStock::SolverResult result = plan.Result();
+	for (size_t i = 0; i < result.remaining.size(); ++i) {
+		const CuttingStock::Part& part = result.remaining[i];
+		const auto m = std::find(demand.materials.begin(), demand.materials.end(), part.material);
+		left[{ static_cast<UInt32>(m - demand.materials.begin()), static_cast<Int32>(std::lround(part.length)) }] -= 1;
+	}
+	std::vector<Int32> used(params.stockTypes.size(), 0);
+	for (const CuttingStock::PlanBoard& b : plan.Boards()) {
+		if (b.cuts.empty()) return false;
+		double length = params.trimLoss;
+		for (size_t c = 0; c < b.cuts.size(); ++c) {
+			length += b.cuts[c] + (c > 0 ? params.slit : 0.0);
+			left[{ static_cast<UInt32>(b.board.materialId < 0 ? 0 : b.board.materialId), b.cuts[c] }] -= 1;
+		}
+		const double rem = b.board.stockLength - length;
+		if (rem < -1e-6) return false;
+		if (params.strictAB && b.cuts.size() > 1 && rem > params.wasteMax + 1e-6 && rem < params.usefulMin - 1e-6) return false;
+		if (static_cast<size_t>(b.board.stockType) < used.size()) used[b.board.stockType] += 1;
+	}
+	for (size_t t = 0; t < used.size(); ++t) {
+		if (params.stockTypes[t].available >= 0 && used[t] > params.stockTypes[t].available) return false;
+	}
+	for (const auto& l : left) {
+		if (l.second != 0) return false;
+	}
+	return true;
+}
+
+// Полное решение задачи, затем opt.edits правок: удаление случайной детали плана или вставка детали
+// материала и ширины одной из групп задачи, длиной в пределах длин задачи (зерно фиксировано — прогоны сравнимы)
+static DynamicOutcome RunDynamic(const Instance& inst, const Options& opt)
+{
+	CuttingStock::DemandSet demand;
+	std::vector<PartGroup> pieces;
+	Int32 shortest = inst.capacity;
+	Int32 longest = 1;
+	for (const PartGroup& g : inst.parts) {
+		shortest = std::min(shortest, g.length);
+		longest = std::max(longest, g.length);
+		CuttingStock::AddDemand(demand, g.length, g.material, g.boardW, g.count);
+		for (Int32 k = 0; k < g.count; ++k) pieces.push_back({ g.length, 1, g.material, g.boardW });
+	}
+	CuttingStock::SolverParams params = MakeParams(inst, opt);
+	params.strictAB = true;
+	if (params.usefulMin <= 0.0) {
+		// У задач bin packing нет полосы A/B — берётся та же доля, что у каркаса (50 и 300 мм на 6000), в целых мм
+		params.wasteMax = std::round(inst.capacity / 120.0);
+		params.usefulMin = std::round(inst.capacity / 20.0);
+	}
+	CuttingStock::DynamicPlan plan(demand, params);
+
+	DynamicOutcome r = {};
+	r.valid = CheckDynamic(plan, params);
+	std::mt19937 rng(20240611u);
+	for (Int32 e = 0; e < opt.edits && r.valid; ++e) {
+		const auto start = std::chrono::steady_clock::now();
+		if (!pieces.empty() && rng() % 2 == 0) {
+			const size_t k = rng() % pieces.size();
+			const PartGroup p = pieces[k];
+			r.valid = plan.Remove(p.length, p.material, p.boardW) == 1;
+			pieces.erase(pieces.begin() + k);
+		} else {
+			const PartGroup& g = inst.parts[rng() % inst.parts.size()];
+			const Int32 length = shortest + static_cast<Int32>(rng() % static_cast<UInt32>(longest - shortest + 1));
+			plan.Insert(length, g.material, g.boardW);
+			pieces.push_back({ length, 1, g.material, g.boardW });
+		}
+		plan.TakeDelta();
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		r.timeMs += ms;
+		r.worstMs = std::max(r.worstMs, ms);
+		r.edits += 1;
+		r.valid = r.valid && CheckDynamic(plan, params);
+	}
+	r.items = static_cast<Int32>(pieces.size());
+	r.boards = static_cast<Int32>(plan.Boards().size());
+	r.unplaced = static_cast<Int32>(plan.Result().remaining.size());
+	return r;
+}
+
+static void PrintDynamicRow(const Instance& inst, const DynamicOutcome& r, bool json)
+{
+	if (json) {
+		std::printf("{\"set\":\"%s\",\"instance\":\"%s\",\"items\":%d,\"edits\":%d,\"boards\":%d,\"unplaced\":%d,"
+			"\"edit_ms\":%.1f,\"worst_edit_ms\":%.3f,\"valid\":%s}\n",
+			inst.set.c_str(), inst.name.c_str(), r.items, r.edits, r.boards, r.unplaced, r.timeMs, r.worstMs, r.valid ? "true" : "false");
+	} else {
+		std::printf("%s,%s,%d,%d,%d,%d,%.1f,%.3f,%d\n",
+			inst.set.c_str(), inst.name.c_str(), r.items, r.edits, r.boards, r.unplaced, r.timeMs, r.worstMs, r.valid ? 1 : 0);
+	}
+	std::fflush(stdout);
+}
+
+static void PrintRow(const Instance& inst, const Outcome& r, bool json)
+{
+	const Int32 reference = inst.optimum > 0 ? inst.optimum : r.lowerBound;
+	const double gap = reference > 0 ? static_cast<double>(r.boards - reference) / reference : 0.0;
+	if (json) {
+		std::printf("{\"set\":\"%s\",\"instance\":\"%s\",\"items\":%d,\"capacity\":%d,\"kerf\":%.1f,\"lower_bound\":%d,"
+			"\"optimum\":%d,\"boards\":%d,\"gap\":%.4f,\"patterns\":%d,\"unplaced\":%d,\"waste_pct\":%.3f,"
+			"\"time_ms\":%.1f,\"interrupted\":%s,\"valid\":%s}\n",
+			inst.set.c_str(), inst.name.c_str(), r.items, inst.capacity, inst.slit, r.lowerBound, inst.optimum, r.boards, gap,
+			r.patterns, r.unplaced, r.wastePct, r.timeMs, r.interrupted ? "true" : "false", r.valid ? "true" : "false");
+	} else {
+		std::printf("%s,%s,%d,%d,%.1f,%d,%d,%d,%.4f,%d,%d,%.3f,%.1f,%d,%d\n",
+			inst.set.c_str(), inst.name.c_str(), r.items, inst.capacity, inst.slit, r.lowerBound, inst.optimum, r.boards, gap,
+			r.patterns, r.unplaced, r.wastePct, r.timeMs, r.interrupted ? 1 : 0, r.valid ? 1 : 0);
+	}
+	std::fflush(stdout);
+}
+
+static void PrintUsage()
+{
+	std::fprintf(stderr,
+		"CuttingStockBenchmark [options]\n"
+		"  --set NAME        only this set (repeatable): falkenauer_u, falkenauer_t, scholl_1, scholl_2, hard, framing\n"
+		"  --bpp FILE        add a BPPLIB instance (n, C, weights); may be repeated\n"
+		"  --opt N           known optimum of the preceding --bpp file\n"
+		"  --mode greedy|cg|svc  solver mode (default greedy)\n"
+		"  --threads N       solver threads (0 = all cores)\n"
+		"  --time-limit MS   SolveControl::timeLimitMs per instance\n"
+		"  --quick           small subset (a few seconds)\n"
+		"  --dynamic N       instead: N random inserts/removes per instance through DynamicPlan (strictAB on),\n"
+		"                    the plan is checked after each edit\n"
+		"  --json            JSON lines instead of CSV\n"
+		"Exit code 1 if any plan is invalid or leaves parts unplaced.\n");
+}
+
+static bool ParseArgs(int argc, char** argv, Options& opt)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string a = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (a == "--set" && hasValue) opt.sets.push_back(argv[++i]);
+		else if (a == "--bpp" && hasValue) opt.files.push_back({ argv[++i], -1 });
+		else if (a == "--opt" && hasValue && !opt.files.empty()) opt.files.back().second = std::atoi(argv[++i]);
+		else if (a == "--threads" && hasValue) opt.threads = std::atoi(argv[++i]);
+		else if (a == "--time-limit" && hasValue) opt.timeLimitMs = std::atoi(argv[++i]);
+		else if (a == "--quick") opt.quick = true;
+		else if (a == "--dynamic" && hasValue) opt.edits = std::max(std::atoi(argv[++i]), 1);
+		else if (a == "--json") opt.json = true;
+		else if (a == "--mode" && hasValue) {
+			const std::string m = argv[++i];
+			if (m == "greedy") opt.mode = CuttingStock::SolverMode::Greedy;
+			else if (m == "cg") opt.mode = CuttingStock::SolverMode::ColumnGeneration;
+			else if (m == "svc") opt.mode = CuttingStock::SolverMode::SequentialValueCorrection;
+			else return false;
+		} else return false;
+	}
+	return true;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+	Options opt;
+	if (!ParseArgs(argc, argv, opt)) {
+		PrintUsage();
+		return 2;
+	}
+
+	std::vector<Instance> instances;
+	const bool generated = opt.files.empty() || !opt.sets.empty();
+	if (generated) {
+		FalkenauerUniform(instances, opt.quick);
+		FalkenauerTriplets(instances, opt.quick);
+		SchollBin1(instances, opt.quick);
+		SchollBin2(instances, opt.quick);
+		Hard(instances, opt.quick);
+		Framing(instances, opt.quick);
+	}
+	if (!opt.sets.empty()) {
+		instances.erase(std::remove_if(instances.begin(), instances.end(), [&](const Instance& inst) {
+			return std::find(opt.sets.begin(), opt.sets.end(), inst.set) == opt.sets.end();
+		}), instances.end());
+	}
+	for (const auto& f : opt.files) {
+		Instance inst;
+		if (!LoadBppFile(f.first, f.second, inst)) {
+			std::fprintf(stderr, "cannot read BPPLIB instance %s\n", f.first.c_str());
+			return 2;
+		}
+		instances.push_back(inst);
+	}
+
+	if (opt.edits > 0) {
+		if (!opt.json)
+			std::printf("set,instance,items,edits,boards,unplaced,edit_ms,worst_edit_ms,valid\n");
+		Int32 invalid = 0;
+		for (const Instance& inst : instances) {
+			const DynamicOutcome r = RunDynamic(inst, opt);
+			PrintDynamicRow(inst, r, opt.json);
+			invalid += r.valid && r.unplaced == 0 ? 0 : 1;
+		}
+		std::fprintf(stderr, "%zu instances, %d with an invalid plan or unplaced parts after edits\n", instances.size(), invalid);
+		return invalid == 0 ? 0 : 1;
+	}
+
+	if (!opt.json)
+		std::printf("set,instance,items,capacity,kerf,lower_bound,optimum,boards,gap,patterns,unplaced,waste_pct,time_ms,interrupted,valid\n");
+
+	// Сводка по наборам: сколько задач на оптимуме (или на нижней оценке), лишние доски, время.
+	struct Summary {
+		Int32 count = 0;
+		Int32 atReference = 0;
+		Int32 extraBoards = 0;
+		double timeMs = 0.0;
+	};
+	std::map<std::string, Summary> summary;
+	bool ok = true;
+	for (const Instance& inst : instances) {
+		const Outcome r = Run(inst, opt);
+		PrintRow(inst, r, opt.json);
+		const Int32 reference = inst.optimum > 0 ? inst.optimum : r.lowerBound;
+		Summary& s = summary[inst.set];
+		s.count += 1;
+		s.atReference += r.boards <= reference ? 1 : 0;
+		s.extraBoards += std::max(0, r.boards - reference);
+		s.timeMs += r.timeMs;
+		ok = ok && r.valid && r.unplaced == 0;
+	}
+	for (const auto& s : summary) {
+		std::fprintf(stderr, "%-14s %4d instances, %4d at optimum/bound, %5d extra boards, %10.1f ms\n",
+			s.first.c_str(), s.second.count, s.second.atReference, s.second.extraBoards, s.second.timeMs);
+	}
+	return ok ? 0 : 1;
+}
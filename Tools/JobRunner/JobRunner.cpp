@@ -0,0 +1,291 @@
+// Пакетный прогон заданий раскроя (*.apjob, пишутся надстройкой при «Сохранить задание»):
+// решатель и экспорт те же, что в RunCuttingPlan, без Archicad. На каждое задание в каталоге вывода —
+// <имя>.csv, <имя>_set_list.csv, <имя>_set_list_summary.csv, <имя>_operator_instructions.txt
+// (при нескольких пилах — ещё <имя>_station<k>_set_list.csv);
+// в stdout — строка CSV с итогом. Задания решаются параллельно.
+
+#include "CuttingStockJob.hpp"
+#include "FastProductionExport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using CuttingStock::Int32;
+
+struct Options {
+	std::vector<fs::path> inputs;
+	fs::path outDir = ".";
+	Int32 jobs = 0;            // заданий одновременно; 0 — по числу ядер
+	Int32 threads = -1;        // потоков решателя на задание; -1 — из задания (1, если заданий несколько)
+	int timeLimitMs = -1;      // -1 — из задания
+	Int32 stations = 0;        // пил; 0 — из задания
+	bool stream = false;       // экспорт по группам ширины, без плана по доскам в памяти (одна пила)
+	bool overrideMode = false;
+	CuttingStock::SolverMode mode = CuttingStock::SolverMode::Greedy;
+};
+
+struct Outcome {
+	bool ok = false;
+	std::string error;
+	Int32 parts = 0;
+	Int32 boards = 0;
+	Int32 unplaced = 0;
+	Int32 patterns = 0;
+	double wastePct = 0.0;
+	double timeMs = 0.0;
+	bool interrupted = false;
+};
+
+static bool ReadFile(const fs::path& path, std::string& out)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) return false;
+	std::ostringstream ss;
+	ss << in.rdbuf();
+	out = ss.str();
+	return static_cast<bool>(in) || in.eof();
+}
+
+// Как WriteUtf8File надстройки: UTF-8 с BOM, чтобы Excel открывал кириллицу
+static bool WriteFile(const fs::path& path, const std::string& text)
+{
+	std::ofstream out(path, std::ios::binary);
+	if (!out) return false;
+	out << "\xEF\xBB\xBF" << text;
+	return static_cast<bool>(out);
+}
+
+// Потоковая запись: BOM при открытии, дальше куски текста по мере готовности
+class StreamFile {
+public:
+	explicit StreamFile(const fs::path& path) : out(path, std::ios::binary) { out << "\xEF\xBB\xBF"; }
+	void Write(const std::string& text) { out << text; }
+	bool Ok() { out.flush(); return static_cast<bool>(out); }
+
+private:
+	std::ofstream out;
+};
+
+// Имя выходных файлов: имя задания без суффикса _job, как у CSV, рядом с которым оно сохранено
+static std::string OutputStem(const fs::path& job)
+{
+	std::string stem = job.stem().string();
+	const std::string suffix = "_job";
+	if (stem.size() > suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0)
+		stem.erase(stem.size() - suffix.size());
+	return stem;
+}
+
+static Outcome RunJob(const fs::path& path, const Options& opt, Int32 solverThreads)
+{
+	Outcome r;
+	std::string text;
+	if (!ReadFile(path, text)) {
+		r.error = "cannot read file";
+		return r;
+	}
+	CuttingJob::Job job;
+	if (!CuttingJob::Read(text, job, r.error))
+		return r;
+	if (opt.overrideMode)
+		job.params.mode = opt.mode;
+	if (solverThreads >= 0)
+		job.params.threadCount = solverThreads;
+	if (opt.timeLimitMs >= 0)
+		job.timeLimitMs = opt.timeLimitMs;
+	if (opt.stations > 0)
+		job.stations.count = opt.stations;
+
+	const CuttingStock::SolverParams params = CuttingJob::SolveParams(job);
+	CuttingStock::SolveControl control;
+	control.timeLimitMs = job.timeLimitMs;
+	const auto start = std::chrono::steady_clock::now();
+	const CuttingStock::PatternResult patterns = CuttingStock::Solve(job.demand, params, control);
+	r.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	const std::string stem = OutputStem(path);
+	bool written = false;
+	if (opt.stream && job.stations.count <= 1) {
+		// План по доскам не собирается целиком: каждая группа ширины пишется сразу
+		StreamFile csv(opt.outDir / (stem + ".csv"));
+		StreamFile setList(opt.outDir / (stem + "_set_list.csv"));
+		StreamFile summary(opt.outDir / (stem + "_set_list_summary.csv"));
+		FastProduction::CutPlanSinks sinks;
+		sinks.csv = [&csv](const std::string& text) { csv.Write(text); };
+		sinks.setList = [&setList](const std::string& text) { setList.Write(text); };
+		sinks.setListSummary = [&summary](const std::string& text) { summary.Write(text); };
+		const std::string instructions = FastProduction::StreamCutPlan(patterns, job.demand, params.slit, job.sections, sinks);
+		written = csv.Ok() && setList.Ok() && summary.Ok() &&
+			WriteFile(opt.outDir / (stem + "_operator_instructions.txt"), instructions);
+	} else {
+		const CuttingStock::SolverResult result = CuttingStock::ExpandResult(patterns, job.demand);
+		FastProduction::ScenarioData scenarioData;
+		const std::string csv = FastProduction::BuildCutPlanCsv(result, params.slit, job.sections, &scenarioData);
+		FastProduction::ScheduleStations(scenarioData, job.stations);
+		written =
+			WriteFile(opt.outDir / (stem + ".csv"), csv) &&
+			WriteFile(opt.outDir / (stem + "_set_list.csv"), FastProduction::BuildSetListCsv(scenarioData)) &&
+			WriteFile(opt.outDir / (stem + "_set_list_summary.csv"), FastProduction::BuildSetListSummaryCsv(scenarioData)) &&
+			WriteFile(opt.outDir / (stem + "_operator_instructions.txt"), FastProduction::BuildOperatorInstructions(scenarioData, result, job.sections));
+		for (size_t st = 0; written && st < scenarioData.stations.size(); ++st) {
+			const std::string name = stem + "_station" + std::to_string(st + 1) + "_set_list.csv";
+			written = WriteFile(opt.outDir / name, FastProduction::BuildStationSetListCsv(scenarioData.stations[st]));
+		}
+	}
+	if (!written) {
+		r.error = "cannot write output";
+		return r;
+	}
+
+	double stock = 0.0;
+	double used = 0.0;
+	for (size_t i = 0; i < job.demand.items.size(); ++i)
+		r.parts += job.demand.items[i].count;
+	for (size_t i = 0; i < patterns.patterns.size(); ++i) {
+		const CuttingStock::CutPattern& pat = patterns.patterns[i];
+		r.boards += pat.count;
+		stock += pat.stockLength * pat.count;
+		for (size_t c = 0; c < pat.cutsMM.size(); ++c)
+			used += static_cast<double>(pat.cutsMM[c]) * pat.count;
+	}
+	for (size_t i = 0; i < patterns.remaining.size(); ++i)
+		r.unplaced += patterns.remaining[i].count;
+	r.patterns = static_cast<Int32>(patterns.patterns.size());
+	r.wastePct = stock > 0.0 ? 100.0 * (stock - used) / stock : 0.0;
+	r.interrupted = patterns.interrupted;
+	r.ok = true;
+	return r;
+}
+
+static void PrintUsage()
+{
+	std::fprintf(stderr,
+		"ArchPlanksJobRunner [options] PATH...\n"
+		"  PATH              job file (.apjob) or directory with job files\n"
+		"  --out DIR         output directory (default: current); files of jobs with equal names overwrite each other\n"
+		"  --jobs N          jobs solved at the same time (0 = all cores)\n"
+		"  --threads N       solver threads per job (default: from the job file, 1 when several jobs run at once)\n"
+		"  --time-limit MS   override the job time limit (0 = no limit)\n"
+		"  --mode greedy|cg|svc  override the solver mode\n"
+		"  --stations N      override the number of saw stations (scenarios are scheduled across them)\n"
+		"  --stream          write the plan one board width at a time instead of building it whole (single station only)\n"
+		"Exit code 1 if any job could not be read, solved or written.\n");
+}
+
+static bool ParseArgs(int argc, char** argv, Options& opt)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string a = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (a == "--out" && hasValue) opt.outDir = argv[++i];
+		else if (a == "--jobs" && hasValue) opt.jobs = std::atoi(argv[++i]);
+		else if (a == "--threads" && hasValue) opt.threads = std::atoi(argv[++i]);
+		else if (a == "--time-limit" && hasValue) opt.timeLimitMs = std::atoi(argv[++i]);
+		else if (a == "--stream") opt.stream = true;
+		else if (a == "--stations" && hasValue) {
+			opt.stations = std::atoi(argv[++i]);
+			if (opt.stations <= 0) return false;
+		}
+		else if (a == "--mode" && hasValue) {
+			const std::string m = argv[++i];
+			if (m == "greedy") opt.mode = CuttingStock::SolverMode::Greedy;
+			else if (m == "cg") opt.mode = CuttingStock::SolverMode::ColumnGeneration;
+			else if (m == "svc") opt.mode = CuttingStock::SolverMode::SequentialValueCorrection;
+			else return false;
+			opt.overrideMode = true;
+		} else if (!a.empty() && a[0] == '-') return false;
+		else opt.inputs.push_back(a);
+	}
+	return !opt.inputs.empty();
+}
+
+// Файлы заданий: явно указанные и *.apjob из каталогов (по имени, для воспроизводимого порядка)
+static std::vector<fs::path> CollectJobs(const std::vector<fs::path>& inputs)
+{
+	std::vector<fs::path> jobs;
+	for (const fs::path& in : inputs) {
+		std::error_code ec;
+		if (!fs::is_directory(in, ec)) {
+			jobs.push_back(in);
+			continue;
+		}
+		std::vector<fs::path> found;
+		for (const fs::directory_entry& e : fs::directory_iterator(in, ec)) {
+			if (e.is_regular_file(ec) && e.path().extension() == ".apjob")
+				found.push_back(e.path());
+		}
+		std::sort(found.begin(), found.end());
+		jobs.insert(jobs.end(), found.begin(), found.end());
+	}
+	return jobs;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+	Options opt;
+	if (!ParseArgs(argc, argv, opt)) {
+		PrintUsage();
+		return 2;
+	}
+	std::error_code ec;
+	fs::create_directories(opt.outDir, ec);
+	if (!fs::is_directory(opt.outDir, ec)) {
+		std::fprintf(stderr, "cannot create output directory %s\n", opt.outDir.string().c_str());
+		return 2;
+	}
+
+	const std::vector<fs::path> jobs = CollectJobs(opt.inputs);
+	if (jobs.empty()) {
+		std::fprintf(stderr, "no job files\n");
+		return 1;
+	}
+	size_t workers = opt.jobs > 0 ? static_cast<size_t>(opt.jobs) : std::thread::hardware_concurrency();
+	workers = std::max<size_t>(1, std::min(workers, jobs.size()));
+	// Параллельно по заданиям; решатель внутри задания — в один поток, чтобы не делить ядра дважды
+	const Int32 solverThreads = opt.threads >= 0 ? opt.threads : (workers > 1 ? 1 : -1);
+
+	std::vector<Outcome> outcomes(jobs.size());
+	std::atomic<size_t> next(0);
+	std::mutex logMutex;
+	auto worker = [&]() {
+		for (;;) {
+			const size_t i = next.fetch_add(1);
+			if (i >= jobs.size()) return;
+			outcomes[i] = RunJob(jobs[i], opt, solverThreads);
+			std::lock_guard<std::mutex> lock(logMutex);
+			std::fprintf(stderr, "[%zu/%zu] %s: %s\n", i + 1, jobs.size(), jobs[i].string().c_str(),
+				outcomes[i].ok ? "done" : outcomes[i].error.c_str());
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < workers; ++t) pool.emplace_back(worker);
+	worker();
+	for (std::thread& t : pool) t.join();
+
+	// Итог — в порядке заданий, а не завершения
+	bool ok = true;
+	std::printf("job,parts,boards,unplaced,patterns,waste_pct,time_ms,interrupted,status\n");
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		const Outcome& r = outcomes[i];
+		std::printf("%s,%d,%d,%d,%d,%.3f,%.1f,%d,%s\n", jobs[i].string().c_str(), r.parts, r.boards, r.unplaced,
+			r.patterns, r.wastePct, r.timeMs, r.interrupted ? 1 : 0, r.ok ? "ok" : "error");
+		ok = ok && r.ok;
+	}
+	return ok ? 0 : 1;
+}